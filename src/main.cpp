@@ -1,10 +1,27 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include <random>
 #include <thread>
 
+#include "perf_counters.hpp"
 #include "pxhash.hpp"
+#include "pxhash_async.hpp"
+#include "pxhash_delta.hpp"
+#include "pxhash_shm.hpp"
+
+#if PXHASH_HAS_SHM
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
 
 #include <benchmark/benchmark.h>
 
@@ -50,22 +67,46 @@ static void printPXHashLogo() {
   std::cout << "------------------------------------------\n\n";
 }
 
-static std::vector<uint64_t> generateKeys(size_t n) {
+static std::vector<uint64_t> generateKeys(size_t n, uint64_t seed = 12345) {
   std::vector<uint64_t> keys(n);
-  std::mt19937_64 rng(12345);
+  std::mt19937_64 rng(seed);
   std::uniform_int_distribution<uint64_t> dist;
   for (size_t i = 0; i < n; ++i) keys[i] = dist(rng);
   return keys;
 }
 
 static std::vector<uint64_t> testKeys = generateKeys(TOTAL_ITEMS);
+static std::vector<uint64_t> missKeys = generateKeys(TOTAL_ITEMS, 54321);
+
+/*!\brief Stop \p perf and publish each counter normalized per key operation. */
+static void reportPerf(benchmark::State& state, pxhash::PerfCounters& perf, size_t keys) {
+  const double ops = static_cast<double>(state.iterations()) * static_cast<double>(keys);
+  for (const auto& s : perf.stop()) {
+    if (ops > 0) state.counters[s.name + "/op"] = s.value / ops;
+  }
+}
+
+static void printPerfStatus() {
+  pxhash::PerfCounters perf;
+  if (!perf.available()) {
+    std::cout << "Hardware counters unavailable (perf_event_open denied or unsupported); "
+                 "reporting wall time only\n\n";
+    return;
+  }
+  std::cout << "Hardware counters per op:";
+  for (const auto& name : perf.names()) std::cout << " " << name;
+  std::cout << "\n\n";
+}
 
 static void BM_PXHash_Insert(benchmark::State& state) {
+  pxhash::PerfCounters perf;
+  perf.start();
   for (auto _ : state) {
     pxhash::PXHash<uint64_t, uint64_t> map(nextPowerOfTwo(TOTAL_ITEMS * 2));
     for (size_t i = 0; i < (size_t)state.range(0); ++i) map.insert(testKeys[i], testKeys[i]);
     benchmark::DoNotOptimize(map);
   }
+  reportPerf(state, perf, (size_t)state.range(0));
 }
 BENCHMARK(BM_PXHash_Insert)->Arg(TOTAL_ITEMS);
 
@@ -74,6 +115,8 @@ static void BM_PXHash_Find(benchmark::State& state) {
   for (size_t i = 0; i < (size_t)state.range(0); ++i) map.insert(testKeys[i], testKeys[i]);
 
   uint64_t found = 0;
+  pxhash::PerfCounters perf;
+  perf.start();
   for (auto _ : state) {
     for (size_t i = 0; i < (size_t)state.range(0); ++i) {
       uint64_t val;
@@ -81,16 +124,143 @@ static void BM_PXHash_Find(benchmark::State& state) {
     }
     benchmark::DoNotOptimize(found);
   }
+  reportPerf(state, perf, (size_t)state.range(0));
 }
 BENCHMARK(BM_PXHash_Find)->Arg(TOTAL_ITEMS);
 
+constexpr size_t PROBE_CAPACITY = size_t{1} << 20;
+
+template <class Probe>
+using ProbeMap = pxhash::PXHash<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, Probe>;
+
+/*!\brief Number of keys that fill a PROBE_CAPACITY table to \p per_mille load (capped below growth). */
+static size_t probeFill(int64_t per_mille) {
+  return std::min(PROBE_CAPACITY * (size_t)per_mille / 1000, PROBE_CAPACITY * 7 / 8 - 1);
+}
+
+// Arg is the final load factor in per mille of a fixed 2^20-slot table.
+template <class Probe>
+static void BM_PXHash_ProbeInsert(benchmark::State& state) {
+  const size_t n = probeFill(state.range(0));
+  pxhash::PerfCounters perf;
+  perf.start();
+  for (auto _ : state) {
+    ProbeMap<Probe> map(n);
+    for (size_t i = 0; i < n; ++i) map.insert(testKeys[i], testKeys[i]);
+    benchmark::DoNotOptimize(map);
+  }
+  reportPerf(state, perf, n);
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+BENCHMARK_TEMPLATE(BM_PXHash_ProbeInsert, pxhash::LinearProbing)->Arg(500)->Arg(750)->Arg(875);
+BENCHMARK_TEMPLATE(BM_PXHash_ProbeInsert, pxhash::TriangularProbing)->Arg(500)->Arg(750)->Arg(875);
+
+// Half of the lookups hit, half miss; reports mean groups scanned for each.
+template <class Probe>
+static void BM_PXHash_ProbeFind(benchmark::State& state) {
+  const size_t n = probeFill(state.range(0));
+  ProbeMap<Probe> map(n);
+  for (size_t i = 0; i < n; ++i) map.insert(testKeys[i], testKeys[i]);
+  if (map.capacity() != PROBE_CAPACITY) {
+    state.SkipWithError("unexpected table capacity");
+    return;
+  }
+
+  size_t hit_groups = 0, miss_groups = 0;
+  for (size_t i = 0; i < n; ++i) {
+    hit_groups += map.probeGroups(testKeys[i]);
+    miss_groups += map.probeGroups(missKeys[i]);
+  }
+
+  uint64_t found = 0;
+  pxhash::PerfCounters perf;
+  perf.start();
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t val;
+      if (map.find(testKeys[i], val)) found++;
+      if (map.find(missKeys[i], val)) found++;
+    }
+    benchmark::DoNotOptimize(found);
+  }
+  reportPerf(state, perf, 2 * n);
+  state.SetItemsProcessed(state.iterations() * (int64_t)(2 * n));
+  state.counters["load"] = (double)map.size() / (double)map.capacity();
+  state.counters["groups/hit"] = (double)hit_groups / (double)n;
+  state.counters["groups/miss"] = (double)miss_groups / (double)n;
+}
+BENCHMARK_TEMPLATE(BM_PXHash_ProbeFind, pxhash::LinearProbing)->Arg(500)->Arg(750)->Arg(875);
+BENCHMARK_TEMPLATE(BM_PXHash_ProbeFind, pxhash::TriangularProbing)->Arg(500)->Arg(750)->Arg(875);
+
+// Two-level lookups: the outer table maps a key to a handle that is looked up in the inner table.
+struct TwoLevelTables {
+  pxhash::PXHash<uint64_t, uint64_t> outer{TOTAL_ITEMS};
+  pxhash::PXHash<uint64_t, uint64_t> inner{TOTAL_ITEMS};
+
+  TwoLevelTables() {
+    for (size_t i = 0; i < TOTAL_ITEMS; ++i) {
+      outer.insert(testKeys[i], missKeys[TOTAL_ITEMS - 1 - i]);
+      inner.insert(missKeys[i], i);
+    }
+  }
+};
+
+static const TwoLevelTables& twoLevelTables() {
+  static const TwoLevelTables tables;
+  return tables;
+}
+
+static void BM_PXHash_TwoLevel_Sync(benchmark::State& state) {
+  const auto& t = twoLevelTables();
+  uint64_t sum = 0;
+  pxhash::PerfCounters perf;
+  perf.start();
+  for (auto _ : state) {
+    for (size_t i = 0; i < TOTAL_ITEMS; ++i) {
+      uint64_t handle, val;
+      if (t.outer.find(testKeys[i], handle) && t.inner.find(handle, val)) sum += val;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  reportPerf(state, perf, TOTAL_ITEMS);
+  state.SetItemsProcessed(state.iterations() * (int64_t)TOTAL_ITEMS);
+}
+BENCHMARK(BM_PXHash_TwoLevel_Sync);
+
+static pxhash::LookupTask twoLevelLookup(const TwoLevelTables& t, uint64_t key, uint64_t& sum) {
+  auto handle = co_await t.outer.findAsync(key);
+  if (!handle) co_return;
+  auto val = co_await t.inner.findAsync(*handle);
+  if (val) sum += *val;
+}
+
+// Arg is the scheduler window (lookups kept in flight).
+static void BM_PXHash_TwoLevel_Async(benchmark::State& state) {
+  const auto& t = twoLevelTables();
+  uint64_t sum = 0;
+  pxhash::PerfCounters perf;
+  perf.start();
+  for (auto _ : state) {
+    pxhash::LookupScheduler scheduler((size_t)state.range(0));
+    for (size_t i = 0; i < TOTAL_ITEMS; ++i) scheduler.spawn(twoLevelLookup(t, testKeys[i], sum));
+    scheduler.run();
+    benchmark::DoNotOptimize(sum);
+  }
+  reportPerf(state, perf, TOTAL_ITEMS);
+  state.SetItemsProcessed(state.iterations() * (int64_t)TOTAL_ITEMS);
+}
+BENCHMARK(BM_PXHash_TwoLevel_Async)->Arg(1)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
+
 static void BM_StdMap_Insert(benchmark::State& state) {
+  pxhash::PerfCounters perf;
+  perf.start();
   for (auto _ : state) {
     std::unordered_map<uint64_t, uint64_t> map;
     map.reserve((size_t)state.range(0));
     for (size_t i = 0; i < (size_t)state.range(0); ++i) map.emplace(testKeys[i], testKeys[i]);
     benchmark::DoNotOptimize(map);
   }
+  reportPerf(state, perf, (size_t)state.range(0));
 }
 BENCHMARK(BM_StdMap_Insert)->Arg(TOTAL_ITEMS);
 
@@ -100,6 +270,8 @@ static void BM_StdMap_Find(benchmark::State& state) {
   for (size_t i = 0; i < (size_t)state.range(0); ++i) map.emplace(testKeys[i], testKeys[i]);
 
   uint64_t found = 0;
+  pxhash::PerfCounters perf;
+  perf.start();
   for (auto _ : state) {
     for (size_t i = 0; i < (size_t)state.range(0); ++i) {
       auto it = map.find(testKeys[i]);
@@ -107,17 +279,21 @@ static void BM_StdMap_Find(benchmark::State& state) {
     }
     benchmark::DoNotOptimize(found);
   }
+  reportPerf(state, perf, (size_t)state.range(0));
 }
 BENCHMARK(BM_StdMap_Find)->Arg(TOTAL_ITEMS);
 
 #if HAVE_ABSL
 static void BM_AbslMap_Insert(benchmark::State& state) {
+  pxhash::PerfCounters perf;
+  perf.start();
   for (auto _ : state) {
     absl::flat_hash_map<uint64_t, uint64_t> map;
     map.reserve((size_t)state.range(0));
     for (size_t i = 0; i < (size_t)state.range(0); ++i) map.emplace(testKeys[i], testKeys[i]);
     benchmark::DoNotOptimize(map);
   }
+  reportPerf(state, perf, (size_t)state.range(0));
 }
 BENCHMARK(BM_AbslMap_Insert)->Arg(TOTAL_ITEMS);
 
@@ -127,6 +303,8 @@ static void BM_AbslMap_Find(benchmark::State& state) {
   for (size_t i = 0; i < (size_t)state.range(0); ++i) map.emplace(testKeys[i], testKeys[i]);
 
   uint64_t found = 0;
+  pxhash::PerfCounters perf;
+  perf.start();
   for (auto _ : state) {
     for (size_t i = 0; i < (size_t)state.range(0); ++i) {
       auto it = map.find(testKeys[i]);
@@ -134,13 +312,261 @@ static void BM_AbslMap_Find(benchmark::State& state) {
     }
     benchmark::DoNotOptimize(found);
   }
+  reportPerf(state, perf, (size_t)state.range(0));
 }
 BENCHMARK(BM_AbslMap_Find)->Arg(TOTAL_ITEMS);
 #endif
 
+// Full-table persistence baseline; fsync'ed so it is comparable to checkpoint().
+static void BM_PXHash_SaveBinary(benchmark::State& state) {
+  const char* path = "pxhash_bench_full.pxh";
+  pxhash::PXHash<uint64_t, uint64_t> map(TOTAL_ITEMS);
+  for (size_t i = 0; i < TOTAL_ITEMS; ++i) map.insert(testKeys[i], testKeys[i]);
+
+  for (auto _ : state) {
+    if (!map.saveBinary(path) || !pxhash::syncPath(path)) state.SkipWithError("saveBinary failed");
+  }
+  std::remove(path);
+}
+BENCHMARK(BM_PXHash_SaveBinary)->Unit(benchmark::kMillisecond);
+
+static void BM_PXHash_LoadBinary(benchmark::State& state) {
+  const char* path = "pxhash_bench_full.pxh";
+  {
+    pxhash::PXHash<uint64_t, uint64_t> map(TOTAL_ITEMS);
+    for (size_t i = 0; i < TOTAL_ITEMS; ++i) map.insert(testKeys[i], testKeys[i]);
+    map.saveBinary(path);
+  }
+
+  for (auto _ : state) {
+    pxhash::PXHash<uint64_t, uint64_t> map;
+    if (!map.loadBinary(path)) state.SkipWithError("loadBinary failed");
+    benchmark::DoNotOptimize(map);
+  }
+  std::remove(path);
+}
+BENCHMARK(BM_PXHash_LoadBinary)->Unit(benchmark::kMillisecond);
+
+/*!\brief Number of keys updated per round for a dirty fraction given in units of 0.1%. */
+static size_t dirtyKeys(int64_t tenths_of_percent) { return TOTAL_ITEMS * (size_t)tenths_of_percent / 1000; }
+
+// Arg is the fraction of keys updated between checkpoints, in units of 0.1%.
+static void BM_DurablePXHash_Checkpoint(benchmark::State& state) {
+  const std::string dir = "pxhash_bench_durable";
+  std::filesystem::remove_all(dir);
+  const size_t dirty = dirtyKeys(state.range(0));
+
+  pxhash::DurablePXHash<uint64_t, uint64_t> store(65536);
+  if (!store.open(dir)) {
+    state.SkipWithError("open failed");
+    return;
+  }
+  for (size_t i = 0; i < TOTAL_ITEMS; ++i) store.insert(testKeys[i], testKeys[i]);
+  store.checkpoint(true);
+
+  size_t round = 0;
+  size_t groups = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < dirty; ++i) {
+      const size_t k = (round * dirty + i) % TOTAL_ITEMS;
+      store.insert(testKeys[k], round);
+    }
+    ++round;
+    groups = store.table().dirtyGroups();
+    state.ResumeTiming();
+
+    if (!store.checkpoint()) state.SkipWithError("checkpoint failed");
+  }
+  state.counters["dirty_groups"] = (double)groups;
+  store.close();
+  std::filesystem::remove_all(dir);
+}
+BENCHMARK(BM_DurablePXHash_Checkpoint)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+// Recovery from a full checkpoint plus a delta log holding the given fraction of updates.
+static void BM_DurablePXHash_Recover(benchmark::State& state) {
+  const std::string dir = "pxhash_bench_recover";
+  const std::string wal_copy = dir + ".wal";
+  std::filesystem::remove_all(dir);
+  const size_t dirty = dirtyKeys(state.range(0));
+
+  {
+    pxhash::DurablePXHash<uint64_t, uint64_t> store(65536);
+    if (!store.open(dir)) {
+      state.SkipWithError("open failed");
+      return;
+    }
+    for (size_t i = 0; i < TOTAL_ITEMS; ++i) store.insert(testKeys[i], testKeys[i]);
+    store.checkpoint(true);
+    for (size_t i = 0; i < dirty; ++i) store.insert(testKeys[i], i);
+  }
+  std::filesystem::copy_file(dir + "/wal.pxl", wal_copy, std::filesystem::copy_options::overwrite_existing);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    // Undo the checkpoint that the previous recovery folded the log into.
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+      if (entry.path().filename() != "ckpt-00000000000000000001.pxc") std::filesystem::remove(entry.path());
+    }
+    std::filesystem::copy_file(wal_copy, dir + "/wal.pxl", std::filesystem::copy_options::overwrite_existing);
+    state.ResumeTiming();
+
+    pxhash::DurablePXHash<uint64_t, uint64_t> store;
+    if (!store.open(dir)) state.SkipWithError("recovery failed");
+    benchmark::DoNotOptimize(store);
+  }
+  std::filesystem::remove_all(dir);
+  std::filesystem::remove(wal_copy);
+}
+BENCHMARK(BM_DurablePXHash_Recover)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+#if PXHASH_HAS_SHM
+/*!\brief Per-process result sent back to the parent over a pipe. */
+struct WorkerReport {
+  double seconds;
+  uint64_t found;
+  uint64_t rss_kb;
+  uint64_t pss_kb;
+};
+
+/*!\brief Read a "Field:  <n> kB" line from a /proc file (0 if unavailable). */
+static uint64_t readProcKb(const char* path, const char* field) {
+  std::ifstream in(path);
+  std::string line;
+  const size_t len = std::strlen(field);
+  while (std::getline(in, line)) {
+    if (line.compare(0, len, field) == 0) return std::strtoull(line.c_str() + len, nullptr, 10);
+  }
+  return 0;
+}
+
+/*!\brief Fork \p n workers that each build a lookup via \p setup and report timing and memory.
+ *
+ * \p setup runs before the clock starts and must leave the table resident; a
+ * worker whose setup fails exits without a report.
+ */
+template <class Setup>
+static std::vector<WorkerReport> runWorkers(size_t n, Setup&& setup) {
+  std::vector<std::pair<pid_t, int>> children;
+  for (size_t w = 0; w < n; ++w) {
+    int fds[2];
+    if (::pipe(fds) != 0) break;
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      ::close(fds[0]);
+      WorkerReport r{};
+      auto lookup = setup();
+      const auto t0 = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < TOTAL_ITEMS; ++i) {
+        uint64_t val;
+        if (lookup(testKeys[i], val)) r.found++;
+      }
+      r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      r.rss_kb = readProcKb("/proc/self/status", "VmRSS:");
+      r.pss_kb = readProcKb("/proc/self/smaps_rollup", "Pss:");
+      ssize_t written = ::write(fds[1], &r, sizeof(r));
+      ::_exit(written == sizeof(r) ? 0 : 1);
+    }
+    ::close(fds[1]);
+    if (pid < 0) {
+      ::close(fds[0]);
+      break;
+    }
+    children.emplace_back(pid, fds[0]);
+  }
+
+  std::vector<WorkerReport> reports;
+  for (auto& [pid, fd] : children) {
+    WorkerReport r{};
+    if (::read(fd, &r, sizeof(r)) == sizeof(r)) reports.push_back(r);
+    ::close(fd);
+    ::waitpid(pid, nullptr, 0);
+  }
+  return reports;
+}
+
+/*!\brief Publish aggregate multi-process counters and use the slowest worker as iteration time. */
+static void reportWorkers(benchmark::State& state, const std::vector<WorkerReport>& reports) {
+  if (reports.size() != (size_t)state.range(0)) {
+    state.SkipWithError("a worker failed to set up its table");
+    return;
+  }
+  for (const auto& r : reports) {
+    if (r.found != TOTAL_ITEMS) {
+      state.SkipWithError("a worker missed keys");
+      return;
+    }
+  }
+
+  double slowest = 0, lookups_per_sec = 0;
+  uint64_t rss_kb = 0, pss_kb = 0;
+  for (const auto& r : reports) {
+    slowest = std::max(slowest, r.seconds);
+    lookups_per_sec += r.seconds > 0 ? TOTAL_ITEMS / r.seconds : 0;
+    rss_kb += r.rss_kb;
+    pss_kb += r.pss_kb;
+  }
+  state.SetIterationTime(slowest);
+  state.counters["lookups/s"] = lookups_per_sec;
+  state.counters["total_rss_MiB"] = rss_kb / 1024.0;
+  state.counters["total_pss_MiB"] = pss_kb / 1024.0;
+}
+
+// Each worker loads a private copy of the table with loadBinary, as done today.
+static void BM_PXHash_MultiProcess_PrivateCopies(benchmark::State& state) {
+  const char* path = "pxhash_bench_table.pxh";
+  {
+    pxhash::PXHash<uint64_t, uint64_t> map(TOTAL_ITEMS);
+    for (size_t i = 0; i < TOTAL_ITEMS; ++i) map.insert(testKeys[i], testKeys[i]);
+    if (!map.saveBinary(path)) {
+      state.SkipWithError("saveBinary failed");
+      return;
+    }
+  }
+
+  for (auto _ : state) {
+    auto reports = runWorkers((size_t)state.range(0), [&] {
+      auto map = std::make_shared<pxhash::PXHash<uint64_t, uint64_t>>();
+      if (!map->loadBinary(path)) ::_exit(2);
+      return [map](uint64_t key, uint64_t& val) { return map->find(key, val); };
+    });
+    reportWorkers(state, reports);
+  }
+  std::remove(path);
+}
+BENCHMARK(BM_PXHash_MultiProcess_PrivateCopies)->Arg(1)->Arg(4)->Arg(8)->UseManualTime()->Iterations(1);
+
+// All workers map one shared segment read-only.
+static void BM_SharedPXHash_MultiProcess(benchmark::State& state) {
+  const std::string name = "/pxhash_bench_" + std::to_string(::getpid());
+  pxhash::SharedPXHash<uint64_t, uint64_t>::unlink(name);
+  pxhash::SharedPXHash<uint64_t, uint64_t> writer;
+  if (!writer.create(name, TOTAL_ITEMS)) {
+    state.SkipWithError("shm segment could not be created");
+    return;
+  }
+  for (size_t i = 0; i < TOTAL_ITEMS; ++i) writer.insert(testKeys[i], testKeys[i]);
+
+  for (auto _ : state) {
+    auto reports = runWorkers((size_t)state.range(0), [&] {
+      auto map = std::make_shared<pxhash::SharedPXHash<uint64_t, uint64_t>>();
+      // open() pre-faults the mapping, matching the private copies that
+      // loadBinary has already touched.
+      if (!map->open(name)) ::_exit(2);
+      return [map](uint64_t key, uint64_t& val) { return map->find(key, val); };
+    });
+    reportWorkers(state, reports);
+  }
+  pxhash::SharedPXHash<uint64_t, uint64_t>::unlink(name);
+}
+BENCHMARK(BM_SharedPXHash_MultiProcess)->Arg(1)->Arg(4)->Arg(8)->UseManualTime()->Iterations(1);
+#endif
+
 int main(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
   printPXHashLogo();
+  printPerfStatus();
   ::benchmark::RunSpecifiedBenchmarks();
   return 0;
 }
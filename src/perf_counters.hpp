@@ -0,0 +1,121 @@
+#ifndef PXHASH_PERF_COUNTERS_HPP
+#define PXHASH_PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+  #define PXHASH_HAS_PERF_EVENTS 1
+#else
+  #define PXHASH_HAS_PERF_EVENTS 0
+#endif
+
+namespace pxhash {
+
+/*!\brief One hardware counter value after multiplexing correction. */
+struct PerfSample {
+  std::string name;
+  double value;
+};
+
+/*!\brief Thin wrapper around Linux perf_event_open for the benchmark harness.
+ *
+ * Each event is opened on its own for the calling thread (user space only), so
+ * a counter that the kernel or perf_event_paranoid rejects is simply dropped.
+ * On non-Linux builds, or when nothing can be opened, the set is empty and
+ * start()/stop() do nothing.
+ */
+class PerfCounters {
+public:
+  PerfCounters() {
+#if PXHASH_HAS_PERF_EVENTS
+    openEvent("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    openEvent("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    openEvent("l1d_misses", PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D));
+    openEvent("llc_misses", PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_LL));
+    openEvent("dtlb_misses", PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_DTLB));
+    openEvent("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+  }
+
+  ~PerfCounters() {
+#if PXHASH_HAS_PERF_EVENTS
+    for (const auto& e : events_) ::close(e.fd);
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  /*!\brief True if at least one counter could be opened. */
+  bool available() const noexcept { return !events_.empty(); }
+
+  /*!\brief Names of the counters that were opened successfully. */
+  std::vector<std::string> names() const {
+    std::vector<std::string> out;
+    for (const auto& e : events_) out.push_back(e.name);
+    return out;
+  }
+
+  /*!\brief Reset and enable all counters. */
+  void start() noexcept {
+#if PXHASH_HAS_PERF_EVENTS
+    for (const auto& e : events_) ::ioctl(e.fd, PERF_EVENT_IOC_RESET, 0);
+    for (const auto& e : events_) ::ioctl(e.fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  /*!\brief Disable all counters and return their values scaled for multiplexing. */
+  std::vector<PerfSample> stop() noexcept {
+    std::vector<PerfSample> out;
+#if PXHASH_HAS_PERF_EVENTS
+    for (const auto& e : events_) ::ioctl(e.fd, PERF_EVENT_IOC_DISABLE, 0);
+    for (const auto& e : events_) {
+      std::uint64_t buf[3] = {0, 0, 0}; // value, time_enabled, time_running
+      if (::read(e.fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf))) continue;
+      if (buf[2] == 0) continue;
+      double value = static_cast<double>(buf[0]);
+      if (buf[2] < buf[1]) value *= static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+      out.push_back({e.name, value});
+    }
+#endif
+    return out;
+  }
+
+private:
+  struct Event {
+    std::string name;
+    int fd;
+  };
+
+  std::vector<Event> events_;
+
+#if PXHASH_HAS_PERF_EVENTS
+  static std::uint64_t cacheConfig(std::uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+
+  void openEvent(const char* name, std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    const long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd >= 0) events_.push_back({name, static_cast<int>(fd)});
+  }
+#endif
+};
+
+} // namespace pxhash
+
+#endif
@@ -1,11 +1,16 @@
 #ifndef PXHASH_HPP
 #define PXHASH_HPP
 
+#include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>
+#include <new>
 #include <functional>
 #include <ios>
+#include <random>
 #include <string_view>
 #include <type_traits>
 #include <utility>
@@ -65,6 +70,135 @@ static inline uint8_t h2_from_hash(size_t h) {
   return static_cast<uint8_t>((h >> (sizeof(size_t) * 8 - 7)) & 0x7F);
 }
 
+/*!\brief Count trailing zero bits of a non-zero group mask. */
+static inline unsigned ctz(uint32_t x) {
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanForward(&idx, x);
+  return (unsigned)idx;
+#else
+  return (unsigned)__builtin_ctz(x);
+#endif
+}
+
+/*!\brief Return a bitmask of slots in the group matching \p h2. */
+static inline uint32_t matchH2Mask(const uint8_t* base, uint8_t h2) {
+#if defined(__AVX2__)
+  __m256i v = _mm256_loadu_si256((const __m256i*)base);
+  __m256i t = _mm256_set1_epi8((char)h2);
+  __m256i c = _mm256_cmpeq_epi8(v, t);
+  return (uint32_t)_mm256_movemask_epi8(c);
+#elif defined(__SSE2__)
+  __m128i v = _mm_loadu_si128((const __m128i*)base);
+  __m128i t = _mm_set1_epi8((char)h2);
+  __m128i c = _mm_cmpeq_epi8(v, t);
+  return (uint32_t)_mm_movemask_epi8(c);
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < GROUP_SIZE; ++i) {
+    if (base[i] == h2) mask |= (uint32_t{1} << i);
+  }
+  return mask;
+#endif
+}
+
+/*!\brief Return a bitmask of EMPTY slots in the group. */
+static inline uint32_t emptyMask(const uint8_t* base) {
+#if defined(__AVX2__)
+  __m256i v = _mm256_loadu_si256((const __m256i*)base);
+  __m256i t = _mm256_set1_epi8((char)EMPTY);
+  __m256i c = _mm256_cmpeq_epi8(v, t);
+  return (uint32_t)_mm256_movemask_epi8(c);
+#elif defined(__SSE2__)
+  __m128i v = _mm_loadu_si128((const __m128i*)base);
+  __m128i t = _mm_set1_epi8((char)EMPTY);
+  __m128i c = _mm_cmpeq_epi8(v, t);
+  return (uint32_t)_mm_movemask_epi8(c);
+#else
+  uint32_t mask = 0;
+  for (size_t i = 0; i < GROUP_SIZE; ++i) {
+    if (base[i] == EMPTY) mask |= (uint32_t{1} << i);
+  }
+  return mask;
+#endif
+}
+
+/*!\brief Hint the CPU to pull the cache line holding \p p into L1. */
+static inline void prefetch(const void* p) {
+#if defined(_MSC_VER)
+  _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+  __builtin_prefetch(p, 0, 3);
+#endif
+}
+
+/*!\brief Allocator returning storage aligned to \p Align bytes.
+ *
+ * Used for control bytes so that aligned groups never straddle a cache line.
+ */
+template <class T, size_t Align>
+struct AlignedAllocator {
+  using value_type = T;
+
+  template <class U>
+  struct rebind {
+    using other = AlignedAllocator<U, Align>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+  }
+  void deallocate(T* p, size_t) noexcept { ::operator delete(p, std::align_val_t(Align)); }
+
+  template <class U>
+  bool operator==(const AlignedAllocator<U, Align>&) const noexcept { return true; }
+  template <class U>
+  bool operator!=(const AlignedAllocator<U, Align>&) const noexcept { return false; }
+};
+
+/*!\brief Probe policy: start at h & mask and advance one group width per step.
+ *
+ * Windows may start at any slot, so a group load can span two cache lines and
+ * neighbouring clusters merge at high load. This is the default.
+ */
+struct LinearProbing {
+  static inline size_t start(size_t h, size_t mask) { return h & mask; }
+  static inline size_t next(size_t idx, size_t /*step*/, size_t mask) {
+    return (idx + GROUP_SIZE) & mask;
+  }
+};
+
+/*!\brief Probe policy: GROUP_SIZE-aligned windows with triangular group stepping.
+ *
+ * The n-th probe lands n*(n+1)/2 groups after the first one, which visits every
+ * group exactly once for power-of-two group counts and breaks up clusters.
+ */
+struct TriangularProbing {
+  static inline size_t start(size_t h, size_t mask) { return h & mask & ~(GROUP_SIZE - 1); }
+  static inline size_t next(size_t idx, size_t step, size_t mask) {
+    return (idx + step * GROUP_SIZE) & mask;
+  }
+};
+
+/*!\brief Resumable lookup state used by interleaved lookups (see beginFind()). */
+struct FindCursor {
+  size_t idx;
+  size_t step;
+  uint32_t match;
+  uint8_t h2;
+  uint8_t stage;
+};
+
+/*!\brief Outcome of one advanceFind() stage. */
+enum class FindStep { Pending, Found, Missing };
+
+template <class Map>
+class FindAwaiter; // pxhash_async.hpp
+
 /*!\brief Simple key/value storage slot. */
 template <class K, class V>
 struct Slot {
@@ -73,16 +207,22 @@ struct Slot {
 };
 
 template <typename KeyType, typename ValueType, typename Hash = std::hash<KeyType>,
-          typename Eq = std::equal_to<KeyType>>
+          typename Eq = std::equal_to<KeyType>, typename Probe = LinearProbing>
 /*!\brief Compact open-addressing hash table inspired by SwissTable.
  *
  * Control bytes store EMPTY/DELETED or a 7-bit hash fingerprint.
- * Probing scans GROUP_SIZE control bytes at a time using SIMD.
+ * Probing scans GROUP_SIZE control bytes at a time using SIMD; \p Probe picks
+ * the window sequence (LinearProbing or TriangularProbing).
  */
 class PXHash {
 public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+
   static constexpr std::uint32_t kBinaryMagic = 0x50584842u; // "PXHB"
   static constexpr std::uint16_t kBinaryVersion = 1;
+  static constexpr std::uint32_t kCheckpointMagic = 0x50584843u; // "PXHC"
+  static constexpr std::uint16_t kCheckpointVersion = 2;
 
   explicit PXHash(size_t initial_capacity = 0) : hasher_(), eq_() {
     //std::cout << "[DEV] Reserving: " << initial_capacity << std::endl;
@@ -97,6 +237,29 @@ public:
 
   size_t size() const noexcept { return size_; }
   bool empty() const noexcept { return size_ == 0; }
+  size_t capacity() const noexcept { return capacity_; }
+
+  /*!\brief Number of groups find(\p key) scans before it returns (diagnostics). */
+  size_t probeGroups(const KeyType& key) const {
+    if (capacity_ == 0) return 0;
+
+    size_t h = hasher_(key);
+    uint8_t h2 = h2_from_hash(h);
+    size_t idx = Probe::start(h, mask_);
+
+    for (size_t step = 1;; ++step) {
+      const uint8_t* base = ctrl_.data() + idx;
+
+      uint32_t m = matchH2Mask(base, h2);
+      while (m) {
+        if (eq_(slots_[(idx + ctz(m)) & mask_].key, key)) return step;
+        m &= (m - 1);
+      }
+
+      if (emptyMask(base)) return step;
+      idx = Probe::next(idx, step, mask_);
+    }
+  }
 
   bool saveBinary(const std::string_view path) const {
     if constexpr (!isBinarySerializable()) {
@@ -164,6 +327,182 @@ public:
     }
   }
 
+  /*!\brief Number of GROUP_SIZE-aligned slot groups modified since the last checkpoint. */
+  size_t dirtyGroups() const noexcept {
+    size_t n = 0;
+    for (std::uint64_t w : dirty_) n += static_cast<size_t>(std::popcount(w));
+    return n;
+  }
+
+  /*!\brief True if the next checkpoint must write every group. */
+  bool nextCheckpointFull() const noexcept { return !has_checkpoint_ || checkpoint_capacity_ != capacity_; }
+
+  /*!\brief Write a group-image checkpoint and clear the dirty bitmap.
+   *
+   * The first checkpoint, and any checkpoint after the capacity changed, is
+   * full: it contains every group. Later ones are incremental and contain only
+   * the groups marked dirty since the previous checkpoint. Each file records a
+   * chain id, drawn afresh for every full checkpoint, and its sequence number
+   * in that chain, so loadCheckpoint() applies an incremental file only right
+   * after its predecessor.
+   */
+  bool saveCheckpoint(const std::string_view path, bool force_full = false) {
+    return writeCheckpoint(path, force_full) && commitCheckpoint();
+  }
+
+  /*!\brief Write a checkpoint like saveCheckpoint() but keep the dirty bitmap.
+   *
+   * Callers that publish the file in further steps (sync, rename) call
+   * commitCheckpoint() once it is durable, without modifying the table in
+   * between. If publishing fails, the next checkpoint still covers the groups.
+   */
+  bool writeCheckpoint(const std::string_view path, bool force_full = false) {
+    checkpoint_pending_ = false;
+    if constexpr (!isBinarySerializable()) {
+      return false;
+    } else {
+      const bool full = force_full || nextCheckpointFull();
+      const size_t groups = capacity_ / GROUP_SIZE;
+      const std::uint64_t group_count = full ? groups : dirtyGroups();
+      const std::uint64_t chain_id = full ? newChainId() : checkpoint_chain_id_;
+      const std::uint64_t prev_seq = full ? 0 : checkpoint_seq_;
+
+      std::ofstream out(std::string(path), std::ios::binary | std::ios::trunc);
+      if (!out) return false;
+
+      if (!writeExact(out, kCheckpointMagic)) return false;
+      if (!writeExact(out, kCheckpointVersion)) return false;
+      if (!writeExact(out, static_cast<std::uint16_t>(full ? kCheckpointFull : 0))) return false;
+      if (!writeExact(out, static_cast<std::uint32_t>(GROUP_SIZE))) return false;
+      if (!writeExact(out, static_cast<std::uint32_t>(sizeof(Slot<KeyType, ValueType>)))) return false;
+      if (!writeExact(out, static_cast<std::uint64_t>(capacity_))) return false;
+      if (!writeExact(out, static_cast<std::uint64_t>(size_))) return false;
+      if (!writeExact(out, static_cast<std::uint64_t>(deleted_))) return false;
+      if (!writeExact(out, group_count)) return false;
+      if (!writeExact(out, chain_id)) return false;
+      if (!writeExact(out, prev_seq)) return false;
+      if (!writeExact(out, static_cast<std::uint64_t>(prev_seq + 1))) return false;
+
+      for (size_t g = 0; g < groups; ++g) {
+        if (!full && !isDirty(g)) continue;
+        if (!writeExact(out, static_cast<std::uint64_t>(g))) return false;
+        out.write(reinterpret_cast<const char*>(ctrl_.data() + g * GROUP_SIZE), GROUP_SIZE);
+        out.write(reinterpret_cast<const char*>(slots_.data() + g * GROUP_SIZE),
+                  GROUP_SIZE * sizeof(Slot<KeyType, ValueType>));
+      }
+
+      if (!out.good()) return false;
+      out.close();
+      if (!out) return false;
+
+      pending_chain_id_ = chain_id;
+      pending_seq_ = prev_seq + 1;
+      checkpoint_pending_ = true;
+      return true;
+    }
+  }
+
+  /*!\brief Make the last writeCheckpoint() the base of the next incremental one.
+   * \return False if no checkpoint was written since the last commit or load.
+   */
+  bool commitCheckpoint() noexcept {
+    if (!checkpoint_pending_) return false;
+    std::fill(dirty_.begin(), dirty_.end(), 0);
+    has_checkpoint_ = true;
+    checkpoint_capacity_ = capacity_;
+    checkpoint_chain_id_ = pending_chain_id_;
+    checkpoint_seq_ = pending_seq_;
+    checkpoint_pending_ = false;
+    return true;
+  }
+
+  /*!\brief Apply a checkpoint written by saveCheckpoint().
+   *
+   * A full checkpoint replaces the table. An incremental one overwrites the
+   * groups it contains and is rejected unless it directly follows the last
+   * checkpoint applied to or committed from this table: same chain id, next
+   * sequence number, same capacity.
+   */
+  bool loadCheckpoint(const std::string_view path) {
+    if constexpr (!isBinarySerializable()) {
+      return false;
+    } else {
+      std::ifstream in(std::string(path), std::ios::binary);
+      if (!in) return false;
+
+      std::uint32_t magic = 0, group_size = 0, slot_size = 0;
+      std::uint16_t version = 0, flags = 0;
+      std::uint64_t cap = 0, size = 0, deleted = 0, group_count = 0;
+      std::uint64_t chain_id = 0, prev_seq = 0, seq = 0;
+
+      if (!readExact(in, magic) || !readExact(in, version) || !readExact(in, flags)) return false;
+      if (!readExact(in, group_size) || !readExact(in, slot_size)) return false;
+      if (!readExact(in, cap) || !readExact(in, size) || !readExact(in, deleted)) return false;
+      if (!readExact(in, group_count)) return false;
+      if (!readExact(in, chain_id) || !readExact(in, prev_seq) || !readExact(in, seq)) return false;
+
+      if (magic != kCheckpointMagic || version != kCheckpointVersion) return false;
+      if (group_size != GROUP_SIZE || slot_size != sizeof(Slot<KeyType, ValueType>)) return false;
+      if (cap % GROUP_SIZE != 0 || (cap & (cap - 1)) != 0 || group_count > cap / GROUP_SIZE) return false;
+
+      const bool full = (flags & kCheckpointFull) != 0;
+      if (seq != prev_seq + 1 || (full && prev_seq != 0)) return false;
+      if (!full && (!has_checkpoint_ || cap != capacity_ || chain_id != checkpoint_chain_id_ ||
+                    prev_seq != checkpoint_seq_)) {
+        return false;
+      }
+
+      PXHash tmp;
+      if (full && cap) tmp.initTable(static_cast<size_t>(cap));
+      PXHash& target = full ? tmp : *this;
+
+      // Stage incremental groups first so a truncated file leaves the table untouched.
+      std::vector<std::uint64_t> group_ids;
+      std::vector<uint8_t> ctrl_buf;
+      std::vector<Slot<KeyType, ValueType>> slot_buf;
+      if (!full) {
+        group_ids.resize(group_count);
+        ctrl_buf.resize(group_count * GROUP_SIZE);
+        slot_buf.resize(group_count * GROUP_SIZE);
+      }
+
+      for (std::uint64_t i = 0; i < group_count; ++i) {
+        std::uint64_t g = 0;
+        if (!readExact(in, g) || g >= cap / GROUP_SIZE) return false;
+        uint8_t* ctrl = full ? target.ctrl_.data() + g * GROUP_SIZE : ctrl_buf.data() + i * GROUP_SIZE;
+        auto* slots = full ? target.slots_.data() + g * GROUP_SIZE : slot_buf.data() + i * GROUP_SIZE;
+        in.read(reinterpret_cast<char*>(ctrl), GROUP_SIZE);
+        in.read(reinterpret_cast<char*>(slots), GROUP_SIZE * sizeof(Slot<KeyType, ValueType>));
+        if (!in) return false;
+        if (!full) group_ids[i] = g;
+      }
+
+      char trailing = 0;
+      if (in.read(&trailing, 1)) return false;
+      if (!in.eof()) return false;
+
+      for (std::uint64_t i = 0; i < group_ids.size(); ++i) {
+        const size_t base = static_cast<size_t>(group_ids[i]) * GROUP_SIZE;
+        std::copy_n(ctrl_buf.data() + i * GROUP_SIZE, GROUP_SIZE, ctrl_.data() + base);
+        std::copy_n(slot_buf.data() + i * GROUP_SIZE, GROUP_SIZE, slots_.data() + base);
+      }
+
+      if (full) *this = std::move(tmp);
+      if (capacity_) {
+        for (size_t i = 0; i < GROUP_SIZE; ++i) ctrl_[capacity_ + i] = ctrl_[i];
+      }
+      size_ = static_cast<size_t>(size);
+      deleted_ = static_cast<size_t>(deleted);
+      std::fill(dirty_.begin(), dirty_.end(), 0);
+      has_checkpoint_ = true;
+      checkpoint_capacity_ = capacity_;
+      checkpoint_chain_id_ = chain_id;
+      checkpoint_seq_ = seq;
+      checkpoint_pending_ = false;
+      return true;
+    }
+  }
+
   /*!\brief Reserve space for at least \p n elements. */
   void reserve(size_t n) {
     // Target max load ~ 7/8.
@@ -194,15 +533,15 @@ public:
 
     size_t h = hasher_(key);
     uint8_t h2 = h2_from_hash(h);
-    size_t idx = h & mask_;
+    size_t idx = Probe::start(h, mask_);
 
-    for (;;) {
+    for (size_t step = 1;; ++step) {
       const uint8_t* base = ctrl_.data() + idx;
 
       uint32_t m = matchH2Mask(base, h2);
       while (m) {
         unsigned bit = ctz(m);
-        size_t pos = idx + bit;
+        size_t pos = (idx + bit) & mask_;
         const auto& s = slots_[pos];
         if (eq_(s.key, key)) {
           out_value = s.value;
@@ -212,10 +551,70 @@ public:
       }
 
       if (emptyMask(base)) return false;
-      idx = (idx + GROUP_SIZE) & mask_;
+      idx = Probe::next(idx, step, mask_);
     }
   }
 
+  /*!\brief Start an incremental lookup and prefetch its first control group.
+   *
+   * Together with advanceFind() this splits find() at each dependent memory
+   * access so that callers can interleave many lookups.
+   */
+  FindCursor beginFind(const KeyType& key) const {
+    FindCursor c{};
+    if (capacity_ == 0) return c;
+
+    size_t h = hasher_(key);
+    c.h2 = h2_from_hash(h);
+    c.idx = Probe::start(h, mask_);
+    c.step = 1;
+    prefetch(ctrl_.data() + c.idx);
+    return c;
+  }
+
+  /*!\brief Run one stage of a lookup begun with beginFind().
+   *
+   * A stage reads memory prefetched by the previous one, then either resolves
+   * the lookup or prefetches the next candidate slot or control group and
+   * returns FindStep::Pending.
+   */
+  FindStep advanceFind(FindCursor& c, const KeyType& key, ValueType& out_value) const {
+    if (capacity_ == 0) return FindStep::Missing;
+
+    const uint8_t* base = ctrl_.data() + c.idx;
+    if (c.stage == 0) {
+      c.match = matchH2Mask(base, c.h2);
+      if (c.match) {
+        prefetch(&slots_[(c.idx + ctz(c.match)) & mask_]);
+        c.stage = 1;
+        return FindStep::Pending;
+      }
+    } else {
+      uint32_t m = c.match;
+      while (m) {
+        const auto& s = slots_[(c.idx + ctz(m)) & mask_];
+        if (eq_(s.key, key)) {
+          out_value = s.value;
+          return FindStep::Found;
+        }
+        m &= (m - 1);
+      }
+    }
+
+    if (emptyMask(base)) return FindStep::Missing;
+    c.idx = Probe::next(c.idx, c.step++, mask_);
+    c.stage = 0;
+    prefetch(ctrl_.data() + c.idx);
+    return FindStep::Pending;
+  }
+
+  /*!\brief Awaitable lookup for LookupTask coroutines; requires pxhash_async.hpp.
+   *
+   * `co_await map.findAsync(key)` yields std::optional<ValueType>. \p key must
+   * stay alive until the co_await completes.
+   */
+  FindAwaiter<PXHash> findAsync(const KeyType& key) const { return FindAwaiter<PXHash>(*this, key); }
+
   /*!\brief Erase a key from the table.
    * \return True if the key was erased, false otherwise.
    */
@@ -224,15 +623,15 @@ public:
 
     size_t h = hasher_(key);
     uint8_t h2 = h2_from_hash(h);
-    size_t idx = h & mask_;
+    size_t idx = Probe::start(h, mask_);
 
-    for (;;) {
+    for (size_t step = 1;; ++step) {
       uint8_t* base = ctrl_.data() + idx;
 
       uint32_t m = matchH2Mask(base, h2);
       while (m) {
         unsigned bit = ctz(m);
-        size_t pos = idx + bit;
+        size_t pos = (idx + bit) & mask_;
         if (ctrl_[pos] == h2 && eq_(slots_[pos].key, key)) {
           setCtrl(pos, DELETED);
           ++deleted_;
@@ -244,7 +643,7 @@ public:
       }
 
       if (emptyMask(base)) return false;
-      idx = (idx + GROUP_SIZE) & mask_;
+      idx = Probe::next(idx, step, mask_);
     }
   }
 
@@ -252,6 +651,7 @@ private:
   static constexpr size_t minCapacity() { return GROUP_SIZE * 2; }
   static constexpr size_t kNumer = 7;
   static constexpr size_t kDenom = 8;
+  static constexpr std::uint16_t kCheckpointFull = 1;
 
   static constexpr bool isBinarySerializable() {
     return std::is_trivially_copyable_v<KeyType> && std::is_trivially_copyable_v<ValueType>;
@@ -268,11 +668,22 @@ private:
   /*!\brief Control bytes for the hash table.
    *
    * The array has capacity_ + GROUP_SIZE bytes so the tail mirrors the first
-   * GROUP_SIZE entries, allowing seamless SIMD loads at the end.
+   * GROUP_SIZE entries, allowing seamless SIMD loads at the end. Storage is
+   * cache-line aligned so that aligned probe windows stay within one line.
    */
-  std::vector<uint8_t> ctrl_;
+  std::vector<uint8_t, AlignedAllocator<uint8_t, 64>> ctrl_;
   std::vector<Slot<KeyType, ValueType>> slots_;
 
+  /*!\brief One bit per GROUP_SIZE-aligned group, set when the group changes. */
+  std::vector<std::uint64_t> dirty_;
+  bool has_checkpoint_{false};
+  size_t checkpoint_capacity_{0};
+  std::uint64_t checkpoint_chain_id_{0};
+  std::uint64_t checkpoint_seq_{0};
+  bool checkpoint_pending_{false};
+  std::uint64_t pending_chain_id_{0};
+  std::uint64_t pending_seq_{0};
+
   template <typename T>
   static bool writeExact(std::ostream& out, const T& value) {
     static_assert(std::is_trivially_copyable_v<T>, "binary writes require trivially copyable types");
@@ -287,20 +698,33 @@ private:
     return static_cast<bool>(in);
   }
 
-  static inline unsigned ctz(uint32_t x) {
-#if defined(_MSC_VER)
-    unsigned long idx;
-    _BitScanForward(&idx, x);
-    return (unsigned)idx;
-#else
-    return (unsigned)__builtin_ctz(x);
-#endif
+  /*!\brief Random non-zero id that tells checkpoint chains apart. */
+  static std::uint64_t newChainId() {
+    std::random_device rd;
+    std::uint64_t id = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    id ^= static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return id ? id : 1;
+  }
+
+  bool isDirty(size_t group) const noexcept { return (dirty_[group >> 6] >> (group & 63)) & 1u; }
+
+  /*!\brief Record that the group holding \p pos changed since the last checkpoint. */
+  inline void markDirty(size_t pos) noexcept {
+    const size_t g = pos / GROUP_SIZE;
+    dirty_[g >> 6] |= std::uint64_t{1} << (g & 63);
+  }
+
+  void markAllDirty() noexcept {
+    const size_t groups = capacity_ / GROUP_SIZE;
+    std::fill(dirty_.begin(), dirty_.end(), ~std::uint64_t{0});
+    if (groups & 63) dirty_.back() = (std::uint64_t{1} << (groups & 63)) - 1;
   }
 
   /*!\brief Set a control byte and keep the tail mirror in sync. */
   inline void setCtrl(size_t pos, uint8_t v) noexcept {
     ctrl_[pos] = v;
     if (pos < GROUP_SIZE) ctrl_[pos + capacity_] = v; // mirror
+    markDirty(pos);
   }
 
   /*!\brief Initialize the table for a given capacity. */
@@ -311,7 +735,8 @@ private:
     deleted_ = 0;
 
     ctrl_.assign(capacity_ + GROUP_SIZE, EMPTY);
-    slots_.resize(capacity_ + GROUP_SIZE);
+    slots_.resize(capacity_);
+    dirty_.assign((capacity_ / GROUP_SIZE + 63) / 64, 0);
     for (size_t i = 0; i < GROUP_SIZE; ++i) ctrl_[capacity_ + i] = ctrl_[i];
   }
 
@@ -328,6 +753,13 @@ private:
         }
       }
     }
+
+    // Slots moved even where the capacity stayed the same, so every group is dirty.
+    tmp.has_checkpoint_ = has_checkpoint_;
+    tmp.checkpoint_capacity_ = checkpoint_capacity_;
+    tmp.checkpoint_chain_id_ = checkpoint_chain_id_;
+    tmp.checkpoint_seq_ = checkpoint_seq_;
+    tmp.markAllDirty();
     *this = std::move(tmp);
   }
 
@@ -344,65 +776,24 @@ private:
     }
   }
 
-  /*!\brief Return a bitmask of slots in the group matching \p h2. */
-  static inline uint32_t matchH2Mask(const uint8_t* base, uint8_t h2) {
-#if defined(__AVX2__)
-    __m256i v = _mm256_loadu_si256((const __m256i*)base);
-    __m256i t = _mm256_set1_epi8((char)h2);
-    __m256i c = _mm256_cmpeq_epi8(v, t);
-    return (uint32_t)_mm256_movemask_epi8(c);
-#elif defined(__SSE2__)
-    __m128i v = _mm_loadu_si128((const __m128i*)base);
-    __m128i t = _mm_set1_epi8((char)h2);
-    __m128i c = _mm_cmpeq_epi8(v, t);
-    return (uint32_t)_mm_movemask_epi8(c);
-#else
-    uint32_t mask = 0;
-    for (size_t i = 0; i < GROUP_SIZE; ++i) {
-      if (base[i] == h2) mask |= (uint32_t{1} << i);
-    }
-    return mask;
-#endif
-  }
-
-  /*!\brief Return a bitmask of EMPTY slots in the group. */
-  static inline uint32_t emptyMask(const uint8_t* base) {
-#if defined(__AVX2__)
-    __m256i v = _mm256_loadu_si256((const __m256i*)base);
-    __m256i t = _mm256_set1_epi8((char)EMPTY);
-    __m256i c = _mm256_cmpeq_epi8(v, t);
-    return (uint32_t)_mm256_movemask_epi8(c);
-#elif defined(__SSE2__)
-    __m128i v = _mm_loadu_si128((const __m128i*)base);
-    __m128i t = _mm_set1_epi8((char)EMPTY);
-    __m128i c = _mm_cmpeq_epi8(v, t);
-    return (uint32_t)_mm_movemask_epi8(c);
-#else
-    uint32_t mask = 0;
-    for (size_t i = 0; i < GROUP_SIZE; ++i) {
-      if (base[i] == EMPTY) mask |= (uint32_t{1} << i);
-    }
-    return mask;
-#endif
-  }
-
   template <class KArg, class VArg>
   /*!\brief Insert or update in-place; assumes capacity is sufficient. */
   void insertOrAssignImpl(KArg&& key, VArg&& value) {
     size_t h = hasher_(key);
     uint8_t h2 = h2_from_hash(h);
-    size_t idx = h & mask_;
+    size_t idx = Probe::start(h, mask_);
 
-    for (;;) {
+    for (size_t step = 1;; ++step) {
       uint8_t* base = ctrl_.data() + idx;
 
       // update existing
       uint32_t m = matchH2Mask(base, h2);
       while (m) {
         unsigned bit = ctz(m);
-        size_t pos = idx + bit;
+        size_t pos = (idx + bit) & mask_;
         if (ctrl_[pos] == h2 && eq_(slots_[pos].key, key)) {
           slots_[pos].value = std::forward<VArg>(value);
+          markDirty(pos);
           return;
         }
         m &= (m - 1);
@@ -415,7 +806,7 @@ private:
 
       if (avail) {
         unsigned bit = ctz(avail);
-        size_t pos = idx + bit;
+        size_t pos = (idx + bit) & mask_;
 
         if (ctrl_[pos] == DELETED) --deleted_;
 
@@ -426,7 +817,7 @@ private:
         return;
       }
 
-      idx = (idx + GROUP_SIZE) & mask_;
+      idx = Probe::next(idx, step, mask_);
     }
   }
 };
@@ -0,0 +1,241 @@
+#ifndef PXHASH_ASYNC_HPP
+#define PXHASH_ASYNC_HPP
+
+#include "pxhash.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <new>
+#include <optional>
+#include <vector>
+
+namespace pxhash {
+
+class LookupScheduler;
+
+/*!\brief Per-thread free lists that recycle coroutine frames by 64-byte size class.
+ *
+ * A lookup task is usually a few hundred bytes and lives for only a few
+ * scheduler turns, so a malloc/free pair per task would cost about as much as
+ * the lookup itself.
+ */
+class FramePool {
+public:
+  static void* allocate(size_t n) {
+    const size_t cls = sizeClass(n);
+    if (cls >= kClasses) return ::operator new(n);
+    auto& list = lists()[cls];
+    if (list.empty()) return ::operator new((cls + 1) * kGranule);
+    void* p = list.back();
+    list.pop_back();
+    return p;
+  }
+
+  static void deallocate(void* p, size_t n) noexcept {
+    const size_t cls = sizeClass(n);
+    if (cls >= kClasses) {
+      ::operator delete(p);
+      return;
+    }
+    auto& list = lists()[cls];
+    if (list.size() < kMaxCached) {
+      list.push_back(p);
+      return;
+    }
+    ::operator delete(p);
+  }
+
+private:
+  static constexpr size_t kGranule = 64;
+  static constexpr size_t kClasses = 16;
+  static constexpr size_t kMaxCached = 1024;
+
+  /*!\brief Owns the cached blocks of one thread and frees them on thread exit. */
+  struct Lists {
+    std::vector<void*> by_class[kClasses];
+    ~Lists() {
+      for (auto& list : by_class) {
+        for (void* p : list) ::operator delete(p);
+      }
+    }
+    std::vector<void*>& operator[](size_t cls) { return by_class[cls]; }
+  };
+
+  static size_t sizeClass(size_t n) { return (n - 1) / kGranule; }
+
+  static Lists& lists() {
+    thread_local Lists l;
+    return l;
+  }
+};
+
+/*!\brief Coroutine type for a request context that issues interleaved lookups.
+ *
+ * A LookupTask does nothing until it is handed to LookupScheduler::spawn(),
+ * which owns it from then on. Inside it, `co_await map.findAsync(key)` parks
+ * the task while the lookup's memory is being fetched.
+ */
+class LookupTask {
+public:
+  struct promise_type {
+    LookupScheduler* scheduler{nullptr};
+
+    static void* operator new(size_t n) { return FramePool::allocate(n); }
+    static void operator delete(void* p, size_t n) noexcept { FramePool::deallocate(p, n); }
+
+    LookupTask get_return_object() noexcept {
+      return LookupTask(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+
+  LookupTask(LookupTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  LookupTask& operator=(LookupTask&& other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  LookupTask(const LookupTask&) = delete;
+  LookupTask& operator=(const LookupTask&) = delete;
+
+  ~LookupTask() {
+    if (handle_) handle_.destroy();
+  }
+
+private:
+  friend class LookupScheduler;
+
+  explicit LookupTask(std::coroutine_handle<promise_type> h) noexcept : handle_(h) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+/*!\brief Round-robin driver that overlaps the memory stalls of many lookups.
+ *
+ * Each parked lookup advances one stage per turn: it reads the memory that it
+ * prefetched on its previous turn, then prefetches the next line it needs. While
+ * that line is in flight, the other parked lookups take their turns. A task is
+ * resumed only after its lookup resolves. spawn() keeps at most
+ * \p max_in_flight lookups parked by running the queue before it starts more
+ * tasks.
+ */
+class LookupScheduler {
+public:
+  explicit LookupScheduler(size_t max_in_flight = 16)
+      : max_in_flight_(max_in_flight ? max_in_flight : 1),
+        ring_(nextPowerOfTwo(max_in_flight_ + 1)),
+        ring_mask_(ring_.size() - 1) {}
+
+  LookupScheduler(const LookupScheduler&) = delete;
+  LookupScheduler& operator=(const LookupScheduler&) = delete;
+
+  ~LookupScheduler() {
+    for (; head_ != tail_; ++head_) ring_[head_ & ring_mask_].handle.destroy();
+  }
+
+  /*!\brief Take ownership of \p task and run it up to its first lookup. */
+  void spawn(LookupTask task) {
+    while (inFlight() >= max_in_flight_) stepOne();
+
+    auto h = std::exchange(task.handle_, {});
+    h.promise().scheduler = this;
+    h.resume();
+    if (h.done()) h.destroy();
+  }
+
+  /*!\brief Drive all spawned tasks to completion. */
+  void run() {
+    while (head_ != tail_) stepOne();
+  }
+
+  /*!\brief Number of tasks currently parked on a lookup. */
+  size_t inFlight() const noexcept { return tail_ - head_; }
+
+private:
+  template <class Map>
+  friend class FindAwaiter;
+
+  struct Parked {
+    std::coroutine_handle<LookupTask::promise_type> handle;
+    void* lookup;
+    bool (*advance)(void*);
+  };
+
+  size_t max_in_flight_;
+  std::vector<Parked> ring_;
+  size_t ring_mask_;
+  size_t head_{0};
+  size_t tail_{0};
+
+  // At most max_in_flight_ tasks are parked, so the ring never overflows.
+  void park(std::coroutine_handle<LookupTask::promise_type> h, void* lookup, bool (*advance)(void*)) {
+    ring_[tail_++ & ring_mask_] = {h, lookup, advance};
+  }
+
+  void stepOne() {
+    Parked p = ring_[head_++ & ring_mask_];
+
+    if (p.advance(p.lookup)) {
+      ring_[tail_++ & ring_mask_] = p;
+      return;
+    }
+
+    p.handle.resume();
+    if (p.handle.done()) p.handle.destroy();
+  }
+};
+
+template <class Map>
+/*!\brief Awaitable returned by PXHash::findAsync(). */
+class FindAwaiter {
+public:
+  using KeyType = typename Map::key_type;
+  using ValueType = typename Map::mapped_type;
+
+  FindAwaiter(const Map& map, const KeyType& key) : map_(map), key_(&key) {}
+
+  bool await_ready() {
+    cursor_ = map_.beginFind(*key_);
+    return false;
+  }
+
+  void await_suspend(std::coroutine_handle<LookupTask::promise_type> h) {
+    h.promise().scheduler->park(h, this, &FindAwaiter::advance);
+  }
+
+  std::optional<ValueType> await_resume() {
+    if (!found_) return std::nullopt;
+    return std::optional<ValueType>(std::move(value_));
+  }
+
+private:
+  const Map& map_;
+  const KeyType* key_;
+  FindCursor cursor_{};
+  ValueType value_{};
+  bool found_{false};
+
+  /*!\brief Run one lookup stage; return true while the lookup is still pending. */
+  static bool advance(void* self) {
+    auto* a = static_cast<FindAwaiter*>(self);
+    switch (a->map_.advanceFind(a->cursor_, *a->key_, a->value_)) {
+      case FindStep::Pending:
+        return true;
+      case FindStep::Found:
+        a->found_ = true;
+        return false;
+      case FindStep::Missing:
+        return false;
+    }
+    return false;
+  }
+};
+
+} // namespace pxhash
+
+#endif
@@ -0,0 +1,437 @@
+#ifndef PXHASH_DELTA_HPP
+#define PXHASH_DELTA_HPP
+
+#include "pxhash.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+  #include <io.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+namespace pxhash {
+
+/*!\brief Flush stdio buffers of \p f and force its contents to stable storage. */
+inline bool syncFile(std::FILE* f) {
+  if (std::fflush(f) != 0) return false;
+#if defined(_WIN32)
+  return _commit(_fileno(f)) == 0;
+#else
+  return ::fsync(::fileno(f)) == 0;
+#endif
+}
+
+/*!\brief Force an existing file to stable storage. */
+inline bool syncPath(const std::string& path) {
+  std::FILE* f = std::fopen(path.c_str(), "r+b");
+  if (!f) return false;
+  const bool ok = syncFile(f);
+  return std::fclose(f) == 0 && ok;
+}
+
+/*!\brief Persist directory entries (renames, creations); a no-op where unsupported. */
+inline bool syncDirectory(const std::string& dir) {
+#if defined(_WIN32)
+  (void)dir;
+  return true;
+#else
+  int fd = ::open(dir.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  const bool ok = ::fsync(fd) == 0;
+  return ::close(fd) == 0 && ok;
+#endif
+}
+
+/*!\brief Operation stored in a delta log record. */
+enum class DeltaOp : std::uint8_t { Insert = 1, Erase = 2 };
+
+/*!\brief Decoded delta log record; \p value is unused for erases. */
+template <class K, class V>
+struct DeltaRecord {
+  DeltaOp op;
+  K key;
+  V value;
+};
+
+template <typename KeyType, typename ValueType>
+/*!\brief Append-only write-ahead log of insert/erase operations.
+ *
+ * Records are encoded as a one-byte op, the raw key and, for inserts, the raw
+ * value. They are staged in a user-space buffer, written out when it fills, and
+ * fsync'ed once every \p sync_every records (or on sync()), so a crash loses at
+ * most the records since the last sync. A record cut short by a crash is
+ * ignored by read().
+ */
+class DeltaLog {
+public:
+  static constexpr std::uint32_t kLogMagic = 0x5058484Cu; // "PXHL"
+  static constexpr std::uint16_t kLogVersion = 1;
+
+  explicit DeltaLog(size_t sync_every = 1024, size_t buffer_bytes = size_t{1} << 16)
+      : sync_every_(sync_every ? sync_every : 1), buffer_bytes_(buffer_bytes) {
+    buffer_.reserve(buffer_bytes_ + kMaxRecord);
+  }
+  ~DeltaLog() { close(); }
+
+  DeltaLog(const DeltaLog&) = delete;
+  DeltaLog& operator=(const DeltaLog&) = delete;
+
+  /*!\brief Open \p path for appending, writing a header if the log is new or \p truncate is set. */
+  bool open(const std::string_view path, bool truncate = false) {
+    close();
+    const std::string p(path);
+
+    if (!truncate) {
+      std::FILE* in = std::fopen(p.c_str(), "rb");
+      if (in) {
+        Header h{};
+        const size_t got = std::fread(&h, 1, sizeof(h), in);
+        std::fclose(in);
+        if (got != 0 && (got != sizeof(h) || h.magic != kLogMagic || h.version != kLogVersion ||
+                         h.key_size != sizeof(KeyType) || h.value_size != sizeof(ValueType))) {
+          return false;
+        }
+        truncate = got == 0;
+      } else {
+        truncate = true;
+      }
+    }
+
+    file_ = std::fopen(p.c_str(), truncate ? "wb" : "ab");
+    if (!file_) return false;
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+
+    if (truncate) {
+      const Header h{kLogMagic, kLogVersion, 0, static_cast<std::uint32_t>(sizeof(KeyType)),
+                     static_cast<std::uint32_t>(sizeof(ValueType))};
+      if (std::fwrite(&h, sizeof(h), 1, file_) != 1 || !syncFile(file_)) {
+        close();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool isOpen() const noexcept { return file_ != nullptr; }
+
+  /*!\brief Size of the log header; a longer file holds (possibly torn) records. */
+  static constexpr size_t headerSize() noexcept { return sizeof(Header); }
+
+  bool appendInsert(const KeyType& key, const ValueType& value) {
+    return append(DeltaOp::Insert, key, &value);
+  }
+
+  bool appendErase(const KeyType& key) { return append(DeltaOp::Erase, key, nullptr); }
+
+  /*!\brief Write buffered records and fsync the log. */
+  bool sync() {
+    if (!file_) return false;
+    if (!writeBuffer()) return false;
+    unsynced_ = 0;
+    return syncFile(file_);
+  }
+
+  /*!\brief Sync and close the log. */
+  void close() noexcept {
+    if (!file_) return;
+    sync();
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+
+  /*!\brief Decode every complete record of the log at \p path into \p out.
+   * \return False if the file is missing or its header does not match.
+   */
+  static bool read(const std::string_view path, std::vector<DeltaRecord<KeyType, ValueType>>& out) {
+    out.clear();
+    std::FILE* in = std::fopen(std::string(path).c_str(), "rb");
+    if (!in) return false;
+
+    Header h{};
+    if (std::fread(&h, sizeof(h), 1, in) != 1 || h.magic != kLogMagic || h.version != kLogVersion ||
+        h.key_size != sizeof(KeyType) || h.value_size != sizeof(ValueType)) {
+      std::fclose(in);
+      return false;
+    }
+
+    std::vector<char> bytes;
+    char chunk[1 << 16];
+    size_t got = 0;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), in)) > 0) bytes.insert(bytes.end(), chunk, chunk + got);
+    std::fclose(in);
+
+    size_t pos = 0;
+    for (;;) {
+      if (pos + 1 + sizeof(KeyType) > bytes.size()) break;
+      DeltaRecord<KeyType, ValueType> r{};
+      r.op = static_cast<DeltaOp>(bytes[pos]);
+      if (r.op != DeltaOp::Insert && r.op != DeltaOp::Erase) break;
+      const size_t len = 1 + sizeof(KeyType) + (r.op == DeltaOp::Insert ? sizeof(ValueType) : 0);
+      if (pos + len > bytes.size()) break;
+      std::memcpy(&r.key, bytes.data() + pos + 1, sizeof(KeyType));
+      if (r.op == DeltaOp::Insert) std::memcpy(&r.value, bytes.data() + pos + 1 + sizeof(KeyType), sizeof(ValueType));
+      out.push_back(r);
+      pos += len;
+    }
+    return true;
+  }
+
+private:
+  static_assert(std::is_trivially_copyable_v<KeyType> && std::is_trivially_copyable_v<ValueType>,
+                "DeltaLog requires trivially copyable keys and values");
+
+  struct Header {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t reserved;
+    std::uint32_t key_size;
+    std::uint32_t value_size;
+  };
+
+  static constexpr size_t kMaxRecord = 1 + sizeof(KeyType) + sizeof(ValueType);
+
+  std::FILE* file_{nullptr};
+  size_t sync_every_;
+  size_t buffer_bytes_;
+  size_t unsynced_{0};
+  std::vector<char> buffer_;
+
+  bool append(DeltaOp op, const KeyType& key, const ValueType* value) {
+    if (!file_) return false;
+
+    const char* k = reinterpret_cast<const char*>(&key);
+    buffer_.push_back(static_cast<char>(op));
+    buffer_.insert(buffer_.end(), k, k + sizeof(KeyType));
+    if (value) {
+      const char* v = reinterpret_cast<const char*>(value);
+      buffer_.insert(buffer_.end(), v, v + sizeof(ValueType));
+    }
+
+    if (++unsynced_ >= sync_every_) return sync();
+    if (buffer_.size() >= buffer_bytes_) return writeBuffer();
+    return true;
+  }
+
+  bool writeBuffer() {
+    if (buffer_.empty()) return true;
+    const bool ok = std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size();
+    buffer_.clear();
+    return ok;
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash = std::hash<KeyType>,
+          typename Eq = std::equal_to<KeyType>, typename Probe = LinearProbing>
+/*!\brief PXHash persisted as a checkpoint chain plus a write-ahead delta log.
+ *
+ * A directory holds numbered checkpoint files (`ckpt-<seq>.pxc`) and `wal.pxl`.
+ * insert()/erase() update the table and append to the log. checkpoint() writes
+ * the groups that changed since the previous checkpoint, or a full image after
+ * a capacity change, and then starts a new log. open() recovers by applying
+ * the checkpoint chain in order and replaying the log.
+ */
+class DurablePXHash {
+public:
+  using Table = PXHash<KeyType, ValueType, Hash, Eq, Probe>;
+
+  explicit DurablePXHash(size_t sync_every = 1024) : log_(sync_every) {}
+
+  DurablePXHash(const DurablePXHash&) = delete;
+  DurablePXHash& operator=(const DurablePXHash&) = delete;
+
+  /*!\brief Open or create the store in \p dir and recover its contents.
+   *
+   * Files that start with "ckpt-" but carry no numeric sequence are ignored.
+   * \param replay_threads Threads used to collapse the log by hash partition (0 = hardware concurrency).
+   */
+  bool open(const std::string_view dir, size_t replay_threads = 0) {
+    log_.close();
+    dir_ = std::filesystem::path(dir);
+    table_ = Table();
+    first_seq_ = 1;
+    next_seq_ = 1;
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    if (ec) return false;
+
+    std::vector<std::pair<std::uint64_t, std::filesystem::path>> checkpoints;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_, ec)) {
+      const std::string name = entry.path().filename().string();
+      if (name.rfind("ckpt-", 0) != 0) continue;
+      if (entry.path().extension() == ".tmp") {
+        std::filesystem::remove(entry.path(), ec);
+      } else if (entry.path().extension() == ".pxc") {
+        std::uint64_t seq = 0;
+        if (parseCheckpointSeq(entry.path().stem().string(), seq)) checkpoints.emplace_back(seq, entry.path());
+      }
+    }
+    if (ec) return false;
+    std::sort(checkpoints.begin(), checkpoints.end());
+    if (!checkpoints.empty()) first_seq_ = checkpoints.front().first;
+
+    for (const auto& [seq, path] : checkpoints) {
+      if (!table_.loadCheckpoint(path.string())) return false;
+      next_seq_ = seq + 1;
+    }
+
+    const std::string wal = walPath();
+    if (std::filesystem::exists(wal, ec) &&
+        std::filesystem::file_size(wal, ec) > DeltaLog<KeyType, ValueType>::headerSize()) {
+      if (!replay(wal, replay_threads)) return false;
+      // Fold the replayed log into a checkpoint so new records never follow a torn tail.
+      return checkpoint();
+    }
+    return log_.open(wal);
+  }
+
+  /*!\brief Sync the log and release the store. */
+  void close() { log_.close(); }
+
+  bool insert(const KeyType& key, const ValueType& value) {
+    table_.insert(key, value);
+    return log_.appendInsert(key, value);
+  }
+
+  /*!\return True if the key was present and the erase was logged. */
+  bool erase(const KeyType& key) {
+    if (!table_.erase(key)) return false;
+    return log_.appendErase(key);
+  }
+
+  bool find(const KeyType& key, ValueType& out_value) const { return table_.find(key, out_value); }
+
+  size_t size() const noexcept { return table_.size(); }
+  const Table& table() const noexcept { return table_; }
+
+  /*!\brief Force logged operations to stable storage. */
+  bool sync() { return log_.sync(); }
+
+  /*!\brief Persist changed groups as the next checkpoint and start a new log. */
+  bool checkpoint(bool force_full = false) {
+    const bool full = force_full || table_.nextCheckpointFull();
+    const std::string final_path = checkpointPath(next_seq_);
+    const std::string tmp_path = final_path + ".tmp";
+
+    // Dirty groups stay marked until the file is durable under its final name,
+    // so a failed attempt is retried in full by the next checkpoint.
+    if (!table_.writeCheckpoint(tmp_path, full)) return false;
+    if (!syncPath(tmp_path)) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, final_path, ec);
+    if (ec || !syncDirectory(dir_.string())) return false;
+    table_.commitCheckpoint();
+
+    // Newest first, so an interrupted cleanup still leaves a loadable prefix.
+    if (full) {
+      for (std::uint64_t seq = next_seq_; seq-- > first_seq_;) std::filesystem::remove(checkpointPath(seq), ec);
+      first_seq_ = next_seq_;
+    }
+    ++next_seq_;
+
+    // The log is now covered by the checkpoint; replaying it again would be harmless.
+    return log_.open(walPath(), true);
+  }
+
+private:
+  std::filesystem::path dir_;
+  Table table_;
+  DeltaLog<KeyType, ValueType> log_;
+  std::uint64_t first_seq_{1}; // oldest checkpoint file that may still exist
+  std::uint64_t next_seq_{1};
+
+  std::string walPath() const { return (dir_ / "wal.pxl").string(); }
+
+  /*!\brief Parse the sequence number of a "ckpt-<seq>" stem; false for any other name. */
+  static bool parseCheckpointSeq(const std::string& stem, std::uint64_t& seq) {
+    const char* first = stem.data() + 5;
+    const char* last = stem.data() + stem.size();
+    if (first == last) return false;
+    const auto [end, err] = std::from_chars(first, last, seq);
+    return err == std::errc() && end == last && seq > 0;
+  }
+
+  std::string checkpointPath(std::uint64_t seq) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "ckpt-%020llu.pxc", static_cast<unsigned long long>(seq));
+    return (dir_ / name).string();
+  }
+
+  /*!\brief Replay \p path into the table.
+   *
+   * Records are split into hash partitions, so all records for one key land in
+   * the same partition. Each partition is collapsed in parallel to the last
+   * operation per key, and only those net operations are applied to the table.
+   */
+  bool replay(const std::string& path, size_t threads) {
+    std::vector<DeltaRecord<KeyType, ValueType>> records;
+    if (!DeltaLog<KeyType, ValueType>::read(path, records)) return false;
+    if (records.empty()) return true;
+
+    if (threads == 0) threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    threads = std::min(threads, std::max<size_t>(1, records.size() / 4096));
+    threads = std::min<size_t>(threads, 255);
+
+    std::vector<uint8_t> partition(records.size());
+    std::vector<std::vector<size_t>> net(threads);
+    std::vector<size_t> fresh(threads, 0);
+
+    auto run = [&](auto&& fn) {
+      std::vector<std::thread> pool;
+      for (size_t t = 1; t < threads; ++t) pool.emplace_back(fn, t);
+      fn(size_t{0});
+      for (auto& th : pool) th.join();
+    };
+
+    run([&](size_t t) {
+      const Hash hasher{};
+      const size_t lo = records.size() * t / threads;
+      const size_t hi = records.size() * (t + 1) / threads;
+      for (size_t i = lo; i < hi; ++i) partition[i] = static_cast<uint8_t>(hasher(records[i].key) % threads);
+    });
+
+    run([&](size_t t) {
+      PXHash<KeyType, size_t, Hash, Eq> last;
+      for (size_t i = 0; i < records.size(); ++i) {
+        if (partition[i] == t) last.insert(records[i].key, i);
+      }
+      for (size_t i = 0; i < records.size(); ++i) {
+        size_t j = 0;
+        if (partition[i] == t && last.find(records[i].key, j) && j == i) net[t].push_back(i);
+      }
+      // Only keys the checkpoint lacks need room; updates are applied in place.
+      ValueType existing{};
+      for (size_t i : net[t]) {
+        if (records[i].op == DeltaOp::Insert && !table_.find(records[i].key, existing)) ++fresh[t];
+      }
+    });
+
+    size_t inserts = 0;
+    for (size_t n : fresh) inserts += n;
+    table_.reserve(table_.size() + inserts);
+
+    for (const auto& part : net) {
+      for (size_t i : part) {
+        const auto& r = records[i];
+        if (r.op == DeltaOp::Insert) table_.insert(r.key, r.value);
+        else table_.erase(r.key);
+      }
+    }
+    return true;
+  }
+};
+
+} // namespace pxhash
+
+#endif
@@ -0,0 +1,557 @@
+#ifndef PXHASH_SHM_HPP
+#define PXHASH_SHM_HPP
+
+#include "pxhash.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+  #define PXHASH_HAS_SHM 1
+#else
+  #define PXHASH_HAS_SHM 0
+#endif
+
+#if PXHASH_HAS_SHM
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pxhash {
+
+/*!\brief Header at offset 0 of a shared PXHash segment.
+ *
+ * Every other region is addressed by an offset from the segment base, so the
+ * segment can be mapped at a different address in each process.
+ */
+struct SharedHeader {
+  std::uint32_t magic;
+  std::uint16_t version;
+  std::uint16_t group_size;
+  std::uint32_t key_size;
+  std::uint32_t value_size;
+  std::uint64_t capacity;
+  std::uint64_t versions_offset;
+  std::uint64_t ctrl_offset;
+  std::uint64_t slots_offset;
+  std::uint64_t total_bytes;
+  std::atomic<std::uint64_t> size;
+  std::atomic<std::uint64_t> deleted;
+  // Odd while the writer rebuilds the table in place; kept on its own cache
+  // line so that size/deleted updates do not invalidate it for readers.
+  alignas(64) std::atomic<std::uint32_t> epoch;
+};
+
+/*!\brief Outcome of SharedPXHash::tryFind(). */
+enum class SharedFindResult {
+  Found,
+  Missing,
+  Stalled // the writer held the key's blocks past the stall timeout
+};
+
+template <typename KeyType, typename ValueType, typename Hash = std::hash<KeyType>,
+          typename Eq = std::equal_to<KeyType>>
+/*!\brief Fixed-capacity PXHash living in a named POSIX shared-memory segment.
+ *
+ * One writer process creates the segment and mutates it; any number of reader
+ * processes open it read-only and call find() concurrently. Each aligned block
+ * of GROUP_SIZE slots carries a sequence counter: the writer makes it odd while
+ * it touches the block and even again afterwards, and readers retry a probe
+ * window whose counters were odd or changed while it was being read.
+ *
+ * The table never grows. erase() leaves a tombstone that a later insert() on
+ * the same probe path reuses; when live entries plus tombstones would pass the
+ * 7/8 load limit, insert() first drops all tombstones with purgeTombstones()
+ * and fails only if live entries alone fill the table. Hash must produce
+ * identical values in every process (no per-process seeding), and keys/values
+ * must be trivially copyable.
+ *
+ * Readers wait for a busy block by spinning, then yielding, for at most the
+ * stall timeout. A writer that dies mid-update leaves its block busy for good;
+ * lookups touching it then report SharedFindResult::Stalled, and the segment
+ * must be recreated.
+ */
+class SharedPXHash {
+public:
+  static constexpr std::uint32_t kSharedMagic = 0x50584853u; // "PXHS"
+  static constexpr std::uint16_t kSharedVersion = 2;
+
+  SharedPXHash() : hasher_(), eq_() {}
+  ~SharedPXHash() { close(); }
+
+  SharedPXHash(const SharedPXHash&) = delete;
+  SharedPXHash& operator=(const SharedPXHash&) = delete;
+
+  SharedPXHash(SharedPXHash&& other) noexcept { *this = std::move(other); }
+  SharedPXHash& operator=(SharedPXHash&& other) noexcept {
+    if (this != &other) {
+      close();
+      base_ = std::exchange(other.base_, nullptr);
+      bytes_ = std::exchange(other.bytes_, 0);
+      writable_ = std::exchange(other.writable_, false);
+      header_ = std::exchange(other.header_, nullptr);
+      versions_ = std::exchange(other.versions_, nullptr);
+      ctrl_ = std::exchange(other.ctrl_, nullptr);
+      slots_ = std::exchange(other.slots_, nullptr);
+      capacity_ = std::exchange(other.capacity_, 0);
+      mask_ = std::exchange(other.mask_, 0);
+      stall_timeout_ = other.stall_timeout_;
+    }
+    return *this;
+  }
+
+  /*!\brief Create a new segment sized for at least \p n elements and map it writable.
+   * \param name POSIX shared-memory name, e.g. "/pxhash-table".
+   * \return False if the segment already exists or cannot be created.
+   */
+  bool create(const std::string_view name, size_t n) {
+    close();
+
+    size_t cap = nextPowerOfTwo((n * kDenom) / kNumer + 1);
+    if (cap < minCapacity()) cap = minCapacity();
+
+    const size_t versions_off = alignUp(sizeof(SharedHeader), kCacheLine);
+    const size_t ctrl_off = alignUp(versions_off + (cap / GROUP_SIZE) * sizeof(Version), kCacheLine);
+    const size_t slots_off = alignUp(ctrl_off + cap + GROUP_SIZE, kCacheLine);
+    const size_t total = slots_off + cap * sizeof(SlotType);
+
+    const std::string shm_name(name);
+    int fd = ::shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return false;
+    if (::ftruncate(fd, static_cast<off_t>(total)) != 0) {
+      ::close(fd);
+      ::shm_unlink(shm_name.c_str());
+      return false;
+    }
+    void* p = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+      ::shm_unlink(shm_name.c_str());
+      return false;
+    }
+
+    // ftruncate zero-fills, so every block version starts out even.
+    auto* hdr = new (p) SharedHeader{};
+    hdr->magic = kSharedMagic;
+    hdr->version = kSharedVersion;
+    hdr->group_size = static_cast<std::uint16_t>(GROUP_SIZE);
+    hdr->key_size = static_cast<std::uint32_t>(sizeof(KeyType));
+    hdr->value_size = static_cast<std::uint32_t>(sizeof(ValueType));
+    hdr->capacity = cap;
+    hdr->versions_offset = versions_off;
+    hdr->ctrl_offset = ctrl_off;
+    hdr->slots_offset = slots_off;
+    hdr->total_bytes = total;
+    hdr->size.store(0, std::memory_order_relaxed);
+    hdr->deleted.store(0, std::memory_order_relaxed);
+    hdr->epoch.store(0, std::memory_order_relaxed);
+    std::memset(static_cast<char*>(p) + ctrl_off, EMPTY, cap + GROUP_SIZE);
+
+    attach(p, total, true);
+    return true;
+  }
+
+  /*!\brief Map an existing segment read-only for concurrent lookups.
+   *
+   * Where the platform supports it the mapping is pre-faulted, so the first
+   * lookups do not pay a page fault per touched page.
+   * \return False if the segment is missing or was built for other key/value types.
+   */
+  bool open(const std::string_view name) {
+    close();
+
+    const std::string shm_name(name);
+    int fd = ::shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SharedHeader)) {
+      ::close(fd);
+      return false;
+    }
+    const size_t total = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, total, PROT_READ, kReaderMapFlags, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    const auto* hdr = static_cast<const SharedHeader*>(p);
+    if (hdr->magic != kSharedMagic || hdr->version != kSharedVersion ||
+        hdr->group_size != GROUP_SIZE || hdr->key_size != sizeof(KeyType) ||
+        hdr->value_size != sizeof(ValueType) || hdr->total_bytes != total) {
+      ::munmap(p, total);
+      return false;
+    }
+
+    attach(p, total, false);
+    return true;
+  }
+
+  /*!\brief Remove a named segment; existing mappings stay valid until closed. */
+  static bool unlink(const std::string_view name) {
+    return ::shm_unlink(std::string(name).c_str()) == 0;
+  }
+
+  /*!\brief Unmap the segment from this process. */
+  void close() noexcept {
+    if (base_) ::munmap(base_, bytes_);
+    base_ = nullptr;
+    bytes_ = 0;
+    writable_ = false;
+    header_ = nullptr;
+    versions_ = nullptr;
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    mask_ = 0;
+  }
+
+  bool isOpen() const noexcept { return base_ != nullptr; }
+  bool writable() const noexcept { return writable_; }
+  size_t capacity() const noexcept { return capacity_; }
+  size_t size() const noexcept {
+    return header_ ? static_cast<size_t>(header_->size.load(std::memory_order_acquire)) : 0;
+  }
+  bool empty() const noexcept { return size() == 0; }
+
+  /*!\brief Insert or update a key. Writer only.
+   * \return False if the mapping is read-only or live entries fill the table.
+   */
+  bool insert(const KeyType& key, const ValueType& value) {
+    if (!writable_) return false;
+
+    size_t h = hasher_(key);
+    uint8_t h2 = h2_from_hash(h);
+    size_t idx = h & mask_;
+    size_t tomb = capacity_;
+    size_t pos;
+
+    for (;;) {
+      const uint8_t* base = ctrl_ + idx;
+
+      uint32_t m = matchH2Mask(base, h2);
+      while (m) {
+        size_t p = (idx + ctz(m)) & mask_;
+        if (eq_(slots_[p].key, key)) {
+          const uint32_t v = beginWrite(p);
+          slots_[p].value = value;
+          endWrite(p, v);
+          return true;
+        }
+        m &= (m - 1);
+      }
+
+      if (tomb == capacity_) {
+        uint32_t d = matchH2Mask(base, DELETED);
+        if (d) tomb = (idx + ctz(d)) & mask_;
+      }
+
+      uint32_t e = emptyMask(base);
+      if (e) {
+        pos = (idx + ctz(e)) & mask_;
+        break;
+      }
+      idx = (idx + GROUP_SIZE) & mask_;
+    }
+
+    const size_t size = header_->size.load(std::memory_order_relaxed);
+    const size_t deleted = header_->deleted.load(std::memory_order_relaxed);
+
+    // Prefer the first tombstone on the probe path: it costs no EMPTY slot.
+    const bool reuse = tomb != capacity_;
+    if (reuse) {
+      pos = tomb;
+    } else if ((size + deleted + 1) * kDenom > capacity_ * kNumer) {
+      if (deleted == 0 || (size + 1) * kDenom > capacity_ * kNumer) return false;
+      purgeTombstones();
+      return insert(key, value);
+    }
+
+    const uint32_t v = beginWrite(pos);
+    slots_[pos].key = key;
+    slots_[pos].value = value;
+    setCtrl(pos, h2);
+    endWrite(pos, v);
+
+    if (reuse) header_->deleted.store(deleted - 1, std::memory_order_relaxed);
+    header_->size.store(size + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*!\brief Rebuild the table in place without tombstones. Writer only.
+   *
+   * Live entries are copied out, the control bytes are reset and the entries
+   * are placed again. The table epoch is odd for the duration, so a reader
+   * whose lookup overlaps the rebuild retries it afterwards.
+   * \return False if the mapping is read-only.
+   */
+  bool purgeTombstones() {
+    if (!writable_) return false;
+
+    std::vector<SlotType> live;
+    live.reserve(size());
+    for (size_t i = 0; i < capacity_; ++i) {
+      const uint8_t c = ctrl_[i];
+      if (c != EMPTY && c != DELETED) live.push_back(slots_[i]);
+    }
+
+    const uint32_t e = header_->epoch.load(std::memory_order_relaxed);
+    header_->epoch.store(e + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memset(ctrl_, EMPTY, capacity_ + GROUP_SIZE);
+    for (const SlotType& s : live) {
+      size_t h = hasher_(s.key);
+      size_t idx = h & mask_;
+      for (;;) {
+        uint32_t m = emptyMask(ctrl_ + idx);
+        if (m) {
+          size_t pos = (idx + ctz(m)) & mask_;
+          slots_[pos] = s;
+          setCtrl(pos, h2_from_hash(h));
+          break;
+        }
+        idx = (idx + GROUP_SIZE) & mask_;
+      }
+    }
+
+    header_->deleted.store(0, std::memory_order_relaxed);
+    header_->epoch.store(e + 2, std::memory_order_release);
+    return true;
+  }
+
+  /*!\brief Find a key and return its value via \p out_value. Safe from any process.
+   * \return True if the key is found; false if it is missing or the lookup stalled.
+   */
+  bool find(const KeyType& key, ValueType& out_value) const {
+    return tryFind(key, out_value) == SharedFindResult::Found;
+  }
+
+  /*!\brief Like find(), but tells a missing key apart from a stalled writer. */
+  SharedFindResult tryFind(const KeyType& key, ValueType& out_value) const {
+    if (!base_) return SharedFindResult::Missing;
+
+    StallWait wait(stall_timeout_);
+    for (;;) {
+      const uint32_t e = header_->epoch.load(std::memory_order_acquire);
+      if (e & 1u) {
+        if (!wait.pause()) return SharedFindResult::Stalled;
+        continue;
+      }
+
+      bool hit = false;
+      const ProbeState state = findInEpoch(key, out_value, hit, wait);
+      if (state == ProbeState::Stalled) return SharedFindResult::Stalled;
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (state == ProbeState::Done && header_->epoch.load(std::memory_order_relaxed) == e) {
+        return hit ? SharedFindResult::Found : SharedFindResult::Missing;
+      }
+      if (!wait.pause()) return SharedFindResult::Stalled;
+    }
+  }
+
+  /*!\brief Longest time a lookup waits for blocks the writer is modifying (default 10 s). */
+  void setStallTimeout(std::chrono::nanoseconds timeout) noexcept { stall_timeout_ = timeout; }
+
+  /*!\brief Erase a key. Writer only; the slot becomes a reusable tombstone.
+   * \return True if the key was erased, false otherwise.
+   */
+  bool erase(const KeyType& key) {
+    if (!writable_) return false;
+
+    size_t h = hasher_(key);
+    uint8_t h2 = h2_from_hash(h);
+    size_t idx = h & mask_;
+
+    for (;;) {
+      const uint8_t* base = ctrl_ + idx;
+
+      uint32_t m = matchH2Mask(base, h2);
+      while (m) {
+        size_t pos = (idx + ctz(m)) & mask_;
+        if (eq_(slots_[pos].key, key)) {
+          const uint32_t v = beginWrite(pos);
+          setCtrl(pos, DELETED);
+          endWrite(pos, v);
+          header_->deleted.fetch_add(1, std::memory_order_relaxed);
+          header_->size.fetch_sub(1, std::memory_order_release);
+          return true;
+        }
+        m &= (m - 1);
+      }
+
+      if (emptyMask(base)) return false;
+      idx = (idx + GROUP_SIZE) & mask_;
+    }
+  }
+
+private:
+  using SlotType = Slot<KeyType, ValueType>;
+  using Version = std::atomic<std::uint32_t>;
+
+  static_assert(std::is_trivially_copyable_v<KeyType> && std::is_trivially_copyable_v<ValueType>,
+                "SharedPXHash requires trivially copyable keys and values");
+  static_assert(Version::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free,
+                "SharedPXHash requires address-free atomics");
+
+  static constexpr size_t minCapacity() { return GROUP_SIZE * 2; }
+  static constexpr size_t kNumer = 7;
+  static constexpr size_t kDenom = 8;
+  static constexpr size_t kCacheLine = 64;
+
+  enum class ProbeState { Done, Retry, Stalled };
+
+  /*!\brief Spin, then yield, until a deadline that starts once spinning stops being cheap. */
+  class StallWait {
+  public:
+    explicit StallWait(std::chrono::nanoseconds timeout) : timeout_(timeout) {}
+
+    /*!\return False once the timeout has passed. */
+    bool pause() {
+      if (++spins_ < kSpins) {
+        cpuRelax();
+        return true;
+      }
+      const auto now = std::chrono::steady_clock::now();
+      if (spins_ == kSpins) deadline_ = now + timeout_;
+      else if (now >= deadline_) return false;
+      std::this_thread::yield();
+      return true;
+    }
+
+  private:
+    static constexpr std::uint64_t kSpins = 1024;
+
+    std::chrono::nanoseconds timeout_;
+    std::chrono::steady_clock::time_point deadline_{};
+    std::uint64_t spins_{0};
+
+    static void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
+      _mm_pause();
+#elif defined(__aarch64__)
+      asm volatile("yield");
+#endif
+    }
+  };
+#if defined(MAP_POPULATE)
+  static constexpr int kReaderMapFlags = MAP_SHARED | MAP_POPULATE;
+#else
+  static constexpr int kReaderMapFlags = MAP_SHARED;
+#endif
+
+  Hash hasher_;
+  Eq eq_;
+
+  void* base_{nullptr};
+  size_t bytes_{0};
+  bool writable_{false};
+
+  SharedHeader* header_{nullptr};
+  Version* versions_{nullptr};
+  uint8_t* ctrl_{nullptr};
+  SlotType* slots_{nullptr};
+  size_t capacity_{0};
+  size_t mask_{0};
+  std::chrono::nanoseconds stall_timeout_{std::chrono::seconds(10)};
+
+  /*!\brief Resolve region pointers from the header offsets of a fresh mapping. */
+  void attach(void* p, size_t total, bool writable) {
+    auto* bytes = static_cast<char*>(p);
+    base_ = p;
+    bytes_ = total;
+    writable_ = writable;
+    header_ = reinterpret_cast<SharedHeader*>(bytes);
+    versions_ = reinterpret_cast<Version*>(bytes + header_->versions_offset);
+    ctrl_ = reinterpret_cast<uint8_t*>(bytes + header_->ctrl_offset);
+    slots_ = reinterpret_cast<SlotType*>(bytes + header_->slots_offset);
+    capacity_ = static_cast<size_t>(header_->capacity);
+    mask_ = capacity_ - 1;
+  }
+
+  /*!\brief Probe for \p key within one table epoch.
+   * \return Retry if the probe gave up because the table was being rebuilt.
+   */
+  ProbeState findInEpoch(const KeyType& key, ValueType& out_value, bool& hit, StallWait& wait) const {
+    size_t h = hasher_(key);
+    uint8_t h2 = h2_from_hash(h);
+    size_t idx = h & mask_;
+
+    // A probe that overlaps a rebuild may see no EMPTY slot; bound it so the
+    // caller can re-check the epoch.
+    for (size_t probes = 0; probes <= capacity_ / GROUP_SIZE; ++probes) {
+      const uint8_t* base = ctrl_ + idx;
+      const size_t b0 = idx / GROUP_SIZE;
+      const size_t b1 = ((idx + GROUP_SIZE - 1) & mask_) / GROUP_SIZE;
+
+      for (;;) {
+        const uint32_t v0 = versions_[b0].load(std::memory_order_acquire);
+        const uint32_t v1 = versions_[b1].load(std::memory_order_acquire);
+        if ((v0 | v1) & 1u) {
+          if (!wait.pause()) return ProbeState::Stalled;
+          continue;
+        }
+
+        hit = false;
+        uint32_t m = matchH2Mask(base, h2);
+        while (m) {
+          size_t pos = (idx + ctz(m)) & mask_;
+          SlotType s;
+          std::memcpy(static_cast<void*>(&s), &slots_[pos], sizeof(SlotType));
+          if (eq_(s.key, key)) {
+            out_value = s.value;
+            hit = true;
+            break;
+          }
+          m &= (m - 1);
+        }
+        const bool stop = hit || emptyMask(base);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (versions_[b0].load(std::memory_order_relaxed) != v0 ||
+            versions_[b1].load(std::memory_order_relaxed) != v1) {
+          continue;
+        }
+
+        if (stop) return ProbeState::Done;
+        break;
+      }
+
+      idx = (idx + GROUP_SIZE) & mask_;
+    }
+    return ProbeState::Retry;
+  }
+
+  /*!\brief Mark the block holding \p pos as being modified. */
+  uint32_t beginWrite(size_t pos) noexcept {
+    Version& v = versions_[pos / GROUP_SIZE];
+    const uint32_t cur = v.load(std::memory_order_relaxed);
+    v.store(cur + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return cur;
+  }
+
+  /*!\brief Publish the modification started by beginWrite(). */
+  void endWrite(size_t pos, uint32_t cur) noexcept {
+    versions_[pos / GROUP_SIZE].store(cur + 2, std::memory_order_release);
+  }
+
+  /*!\brief Set a control byte and keep the tail mirror in sync. */
+  void setCtrl(size_t pos, uint8_t v) noexcept {
+    ctrl_[pos] = v;
+    if (pos < GROUP_SIZE) ctrl_[pos + capacity_] = v; // mirror
+  }
+};
+
+} // namespace pxhash
+
+#endif // PXHASH_HAS_SHM
+
+#endif
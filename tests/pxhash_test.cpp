@@ -1,11 +1,28 @@
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdio>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "pxhash.hpp"
+#include "pxhash_async.hpp"
+#include "pxhash_delta.hpp"
+#include "pxhash_shm.hpp"
+
+#if PXHASH_HAS_SHM
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
 
 namespace {
 
@@ -13,6 +30,13 @@ struct ConstantHash {
   std::size_t operator()(std::uint64_t) const noexcept { return 0; }
 };
 
+// Keys below 100 start probing at the last slot, the rest at slot 0 with a different h2.
+struct WrapAroundHash {
+  std::size_t operator()(std::uint64_t key) const noexcept {
+    return key < 100 ? (~std::size_t{0} >> 7) : (std::size_t{0x7F} << (sizeof(std::size_t) * 8 - 7));
+  }
+};
+
 void test_insert_find_and_update() {
   pxhash::PXHash<std::string, int> map;
 
@@ -112,6 +136,137 @@ void test_collision_heavy_workload() {
   }
 }
 
+void test_probe_window_wrapping_keeps_tail_entries() {
+  pxhash::PXHash<std::uint64_t, std::uint64_t, WrapAroundHash> map;
+
+  map.insert(1, 10);
+  map.insert(2, 20);
+  map.insert(100, 1000);
+  map.insert(101, 1010);
+
+  std::uint64_t value = 0;
+  assert(map.find(1, value) && value == 10);
+  assert(map.find(2, value) && value == 20);
+  assert(map.find(100, value) && value == 1000);
+  assert(map.find(101, value) && value == 1010);
+
+  assert(map.erase(100));
+  assert(map.find(2, value) && value == 20);
+}
+
+void test_triangular_probing_policy() {
+  using TriangularMap = pxhash::PXHash<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>,
+                                       std::equal_to<std::uint64_t>, pxhash::TriangularProbing>;
+  TriangularMap map;
+
+  for (std::uint64_t i = 0; i < 4096; ++i) {
+    map.insert(i * 7919, i);
+  }
+  for (std::uint64_t i = 0; i < 2048; ++i) {
+    assert(map.erase(i * 7919));
+  }
+
+  assert(map.size() == 2048);
+
+  std::uint64_t value = 0;
+  for (std::uint64_t i = 0; i < 4096; ++i) {
+    if (i < 2048) {
+      assert(!map.find(i * 7919, value));
+    } else {
+      assert(map.find(i * 7919, value));
+      assert(value == i);
+      assert(map.probeGroups(i * 7919) >= 1);
+    }
+  }
+}
+
+void test_triangular_probing_visits_every_group() {
+  using TriangularMap = pxhash::PXHash<std::uint64_t, std::uint64_t, ConstantHash,
+                                       std::equal_to<std::uint64_t>, pxhash::TriangularProbing>;
+  TriangularMap map;
+
+  for (std::uint64_t i = 0; i < 96; ++i) {
+    map.insert(i, i * 2);
+  }
+
+  std::uint64_t value = 0;
+  for (std::uint64_t i = 0; i < 96; ++i) {
+    assert(map.find(i, value));
+    assert(value == i * 2);
+  }
+  assert(!map.find(500, value));
+}
+
+template <class Map>
+pxhash::LookupTask lookupInto(const Map& map, std::uint64_t key, std::optional<std::uint64_t>& out) {
+  out = co_await map.findAsync(key);
+}
+
+template <class Outer, class Inner>
+pxhash::LookupTask twoLevelLookup(const Outer& outer, const Inner& inner, std::uint64_t key,
+                                  std::uint64_t& sum, std::uint64_t& completed) {
+  auto handle = co_await outer.findAsync(key);
+  if (handle) {
+    auto value = co_await inner.findAsync(*handle);
+    if (value) sum += *value;
+  }
+  ++completed;
+}
+
+void test_async_find_matches_sync_find() {
+  pxhash::PXHash<std::uint64_t, std::uint64_t> map;
+  for (std::uint64_t i = 0; i < 1000; ++i) {
+    map.insert(i * 3, i);
+  }
+
+  for (std::size_t window : {std::size_t{1}, std::size_t{8}, std::size_t{64}}) {
+    std::vector<std::optional<std::uint64_t>> results(3000);
+    pxhash::LookupScheduler scheduler(window);
+    for (std::uint64_t k = 0; k < results.size(); ++k) {
+      scheduler.spawn(lookupInto(map, k, results[k]));
+      assert(scheduler.inFlight() <= window);
+    }
+    scheduler.run();
+    assert(scheduler.inFlight() == 0);
+
+    for (std::uint64_t k = 0; k < results.size(); ++k) {
+      if (k % 3 == 0) {
+        assert(results[k] && *results[k] == k / 3);
+      } else {
+        assert(!results[k]);
+      }
+    }
+  }
+
+  pxhash::PXHash<std::uint64_t, std::uint64_t> empty;
+  std::optional<std::uint64_t> out = 7;
+  pxhash::LookupScheduler scheduler;
+  scheduler.spawn(lookupInto(empty, 1, out));
+  scheduler.run();
+  assert(!out);
+}
+
+void test_async_find_dependent_lookups_over_collisions() {
+  pxhash::PXHash<std::uint64_t, std::uint64_t, ConstantHash> outer;
+  pxhash::PXHash<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>,
+                 std::equal_to<std::uint64_t>, pxhash::TriangularProbing> inner;
+  for (std::uint64_t i = 0; i < 96; ++i) {
+    outer.insert(i, i + 500);
+    inner.insert(i + 500, i * 2);
+  }
+
+  std::uint64_t sum = 0, completed = 0, expected = 0;
+  pxhash::LookupScheduler scheduler(4);
+  for (std::uint64_t i = 0; i < 128; ++i) {
+    scheduler.spawn(twoLevelLookup(outer, inner, i, sum, completed));
+    if (i < 96) expected += i * 2;
+  }
+  scheduler.run();
+
+  assert(completed == 128);
+  assert(sum == expected);
+}
+
 void test_move_insert_support() {
   pxhash::PXHash<std::string, std::string> map;
   std::string key = "k";
@@ -157,6 +312,528 @@ void test_binary_serialization_rejects_non_trivial_types() {
   assert(!map.loadBinary("pxhash_strings.bin"));
 }
 
+void test_durable_checkpoint_retries_after_failed_publish() {
+  const std::string dir = "pxhash_durable_retry_test";
+  std::filesystem::remove_all(dir);
+
+  {
+    pxhash::DurablePXHash<std::uint64_t, std::uint64_t> store;
+    assert(store.open(dir));
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+      assert(store.insert(i, i));
+    }
+    assert(store.checkpoint());
+
+    for (std::uint64_t i = 0; i < 100; ++i) {
+      assert(store.insert(i, i + 1));
+    }
+    const std::size_t dirty = store.table().dirtyGroups();
+    assert(dirty > 0);
+
+    // A directory at the next checkpoint name makes the rename fail.
+    const std::string blocker = dir + "/ckpt-00000000000000000002.pxc";
+    assert(std::filesystem::create_directory(blocker));
+    assert(!store.checkpoint());
+    assert(store.table().dirtyGroups() == dirty);
+
+    std::filesystem::remove_all(blocker);
+    assert(store.checkpoint());
+    assert(store.table().dirtyGroups() == 0);
+    store.close();
+  }
+
+  // Stray names must not be mistaken for checkpoints.
+  for (const char* stray : {"/ckpt-abc.pxc", "/ckpt-.pxc", "/ckpt-99999999999999999999999.pxc"}) {
+    std::ofstream(dir + stray) << "not a checkpoint";
+  }
+
+  pxhash::DurablePXHash<std::uint64_t, std::uint64_t> store;
+  assert(store.open(dir));
+  assert(store.size() == 1000);
+  std::uint64_t value = 0;
+  for (std::uint64_t i = 0; i < 1000; ++i) {
+    assert(store.find(i, value));
+    assert(value == (i < 100 ? i + 1 : i));
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+void test_durable_replay_of_updates_keeps_capacity() {
+  const std::string dir = "pxhash_durable_updates_test";
+  std::filesystem::remove_all(dir);
+
+  std::size_t capacity = 0;
+  {
+    pxhash::DurablePXHash<std::uint64_t, std::uint64_t> store;
+    assert(store.open(dir));
+    for (std::uint64_t i = 0; i < 14000; ++i) {
+      assert(store.insert(i, i));
+    }
+    capacity = store.table().capacity();
+    assert(store.size() * 10 > capacity * 8);
+    assert(store.checkpoint());
+
+    // Updates only: the log holds no new keys.
+    for (std::uint64_t i = 0; i < 3000; ++i) {
+      assert(store.insert(i, i + 7));
+    }
+    assert(store.sync());
+  }
+
+  pxhash::DurablePXHash<std::uint64_t, std::uint64_t> store;
+  assert(store.open(dir));
+  assert(store.size() == 14000);
+  assert(store.table().capacity() == capacity);
+  assert(!store.table().nextCheckpointFull());
+  // The replayed log was folded into an incremental file on top of the first one.
+  assert(std::filesystem::exists(dir + "/ckpt-00000000000000000001.pxc"));
+
+  std::uint64_t value = 0;
+  for (std::uint64_t i = 0; i < 14000; ++i) {
+    assert(store.find(i, value));
+    assert(value == (i < 3000 ? i + 7 : i));
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+std::size_t countCheckpointFiles(const std::string& dir) {
+  std::size_t n = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+    if (entry.path().extension() == ".pxc") ++n;
+  }
+  return n;
+}
+
+void test_durable_full_checkpoint_removes_live_chain() {
+  const std::string dir = "pxhash_durable_cleanup_test";
+  std::filesystem::remove_all(dir);
+
+  {
+    pxhash::DurablePXHash<std::uint64_t, std::uint64_t> store;
+    assert(store.open(dir));
+    for (std::uint64_t round = 0; round < 3; ++round) {
+      assert(store.insert(round, round));
+      assert(store.checkpoint());
+    }
+    assert(countCheckpointFiles(dir) == 3);
+
+    assert(store.checkpoint(true));
+    assert(countCheckpointFiles(dir) == 1);
+    assert(std::filesystem::exists(dir + "/ckpt-00000000000000000004.pxc"));
+
+    assert(store.insert(10, 10));
+    assert(store.checkpoint());
+    assert(countCheckpointFiles(dir) == 2);
+  }
+
+  // After reopening, the live chain starts at the first file left on disk.
+  pxhash::DurablePXHash<std::uint64_t, std::uint64_t> store;
+  assert(store.open(dir));
+  assert(store.size() == 4);
+  assert(store.checkpoint(true));
+  assert(countCheckpointFiles(dir) == 1);
+  assert(std::filesystem::exists(dir + "/ckpt-00000000000000000006.pxc"));
+
+  std::filesystem::remove_all(dir);
+}
+
+void test_incremental_checkpoint_chain() {
+  const char* base = "pxhash_ckpt_base.pxc";
+  const char* delta = "pxhash_ckpt_delta.pxc";
+  const char* delta2 = "pxhash_ckpt_delta2.pxc";
+  const char* foreign = "pxhash_ckpt_foreign.pxc";
+
+  pxhash::PXHash<std::uint64_t, std::uint64_t> original;
+  for (std::uint64_t i = 0; i < 4096; ++i) {
+    original.insert(i, i);
+  }
+  assert(original.nextCheckpointFull());
+  assert(original.saveCheckpoint(base));
+  assert(original.dirtyGroups() == 0);
+  assert(!original.nextCheckpointFull());
+
+  original.insert(7, 700);
+  original.insert(5000, 5);
+  assert(original.erase(100));
+  assert(original.dirtyGroups() > 0);
+  assert(original.dirtyGroups() <= 3);
+  assert(original.saveCheckpoint(delta));
+
+  pxhash::PXHash<std::uint64_t, std::uint64_t> restored;
+  assert(!restored.loadCheckpoint(delta));
+  assert(restored.loadCheckpoint(base));
+  assert(restored.size() == 4096);
+  assert(restored.loadCheckpoint(delta));
+  assert(restored.size() == original.size());
+
+  std::uint64_t value = 0;
+  assert(restored.find(7, value) && value == 700);
+  assert(restored.find(5000, value) && value == 5);
+  assert(!restored.find(100, value));
+  for (std::uint64_t i = 0; i < 4096; ++i) {
+    if (i == 7 || i == 100) continue;
+    assert(restored.find(i, value) && value == i);
+  }
+
+  // Incrementals must follow their predecessor in the same chain.
+  original.insert(9000, 900);
+  assert(original.saveCheckpoint(delta2));
+  assert(!restored.loadCheckpoint(delta));
+  assert(restored.loadCheckpoint(delta2));
+  assert(restored.find(9000, value) && value == 900);
+
+  pxhash::PXHash<std::uint64_t, std::uint64_t> skipped;
+  assert(skipped.loadCheckpoint(base));
+  assert(!skipped.loadCheckpoint(delta2));
+  assert(!skipped.find(9000, value));
+  assert(skipped.find(7, value) && value == 7);
+
+  pxhash::PXHash<std::uint64_t, std::uint64_t> twin;
+  for (std::uint64_t i = 0; i < 4096; ++i) {
+    twin.insert(i, i + 1);
+  }
+  assert(twin.capacity() == original.capacity());
+  assert(twin.saveCheckpoint(foreign));
+  assert(!twin.loadCheckpoint(delta));
+  assert(twin.find(7, value) && value == 8);
+  assert(restored.loadCheckpoint(foreign));
+  assert(restored.find(7, value) && value == 8);
+
+  // Growth changes the layout, so the next checkpoint is full again.
+  for (std::uint64_t i = 10000; i < 20000; ++i) {
+    original.insert(i, i);
+  }
+  assert(original.nextCheckpointFull());
+
+  pxhash::PXHash<std::uint64_t, std::uint64_t> other;
+  other.insert(1, 1);
+  assert(!other.loadCheckpoint(delta));
+
+  std::remove(base);
+  std::remove(delta);
+  std::remove(delta2);
+  std::remove(foreign);
+}
+
+void test_delta_log_ignores_torn_tail() {
+  const char* path = "pxhash_delta.pxl";
+  {
+    pxhash::DeltaLog<std::uint64_t, std::uint64_t> log(2);
+    assert(log.open(path, true));
+    assert(log.appendInsert(1, 10));
+    assert(log.appendErase(2));
+    assert(log.appendInsert(3, 30));
+  }
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out.put(static_cast<char>(pxhash::DeltaOp::Insert));
+    out.put(0x11);
+  }
+
+  using Log = pxhash::DeltaLog<std::uint64_t, std::uint64_t>;
+  std::vector<pxhash::DeltaRecord<std::uint64_t, std::uint64_t>> records;
+  assert(Log::read(path, records));
+  assert(records.size() == 3);
+  assert(records[0].op == pxhash::DeltaOp::Insert && records[0].key == 1 && records[0].value == 10);
+  assert(records[1].op == pxhash::DeltaOp::Erase && records[1].key == 2);
+  assert(records[2].key == 3 && records[2].value == 30);
+
+  pxhash::DeltaLog<std::uint32_t, std::uint64_t> mismatched;
+  assert(!mismatched.open(path));
+
+  std::remove(path);
+}
+
+void writeDurableFixture(const std::string& dir) {
+  std::filesystem::remove_all(dir);
+
+  pxhash::DurablePXHash<std::uint64_t, std::uint64_t> store;
+  assert(store.open(dir));
+  for (std::uint64_t i = 0; i < 20000; ++i) {
+    assert(store.insert(i, i));
+  }
+  assert(store.checkpoint());
+
+  for (std::uint64_t i = 0; i < 100; ++i) {
+    assert(store.insert(i, i + 1));
+  }
+  assert(store.checkpoint());
+
+  // Logged after the last checkpoint: overwrite, erase, re-insert.
+  for (std::uint64_t i = 0; i < 20000; i += 2) {
+    assert(store.insert(i, i * 3));
+  }
+  for (std::uint64_t i = 0; i < 1000; ++i) {
+    assert(store.erase(i));
+  }
+  for (std::uint64_t i = 0; i < 500; ++i) {
+    assert(store.insert(i, 42));
+  }
+  assert(store.sync());
+}
+
+void test_durable_table_recovers_checkpoints_and_log() {
+  const std::string dir = "pxhash_durable_test";
+
+  for (std::size_t threads : {std::size_t{1}, std::size_t{4}}) {
+    writeDurableFixture(dir);
+
+    // Recover twice: first replaying the log, then from the checkpoint it was folded into.
+    for (int pass = 0; pass < 2; ++pass) {
+      pxhash::DurablePXHash<std::uint64_t, std::uint64_t> store;
+      assert(store.open(dir, threads));
+      assert(store.size() == 19500);
+
+      std::uint64_t value = 0;
+      for (std::uint64_t i = 0; i < 20000; ++i) {
+        if (i < 500) {
+          assert(store.find(i, value) && value == 42);
+        } else if (i < 1000) {
+          assert(!store.find(i, value));
+        } else {
+          assert(store.find(i, value));
+          assert(value == (i % 2 == 0 ? i * 3 : i));
+        }
+      }
+    }
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+#if PXHASH_HAS_SHM
+using SharedMap = pxhash::SharedPXHash<std::uint64_t, std::uint64_t>;
+
+std::string sharedTestName(const char* tag) {
+  return "/pxhash_test_" + std::string(tag) + "_" + std::to_string(::getpid());
+}
+
+void test_shared_table_writer_and_reader_views() {
+  const std::string name = sharedTestName("views");
+  SharedMap::unlink(name);
+
+  SharedMap writer;
+  assert(writer.create(name, 256));
+  assert(writer.writable());
+
+  SharedMap duplicate;
+  assert(!duplicate.create(name, 256));
+
+  for (std::uint64_t i = 0; i < 256; ++i) {
+    assert(writer.insert(i, i * 3));
+  }
+  assert(writer.insert(7, 700));
+
+  SharedMap reader;
+  assert(reader.open(name));
+  assert(!reader.writable());
+  assert(reader.size() == 256);
+  assert(!reader.insert(1000, 1));
+  assert(!reader.erase(1));
+
+  std::uint64_t value = 0;
+  assert(reader.find(7, value));
+  assert(value == 700);
+  for (std::uint64_t i = 8; i < 256; ++i) {
+    assert(reader.find(i, value));
+    assert(value == i * 3);
+  }
+
+  for (std::uint64_t i = 0; i < 128; ++i) {
+    assert(writer.erase(i));
+  }
+  assert(reader.size() == 128);
+  assert(!reader.find(0, value));
+  assert(reader.find(200, value));
+
+  pxhash::SharedPXHash<std::uint64_t, std::uint32_t> mismatched;
+  assert(!mismatched.open(name));
+
+  assert(SharedMap::unlink(name));
+}
+
+void test_shared_table_rejects_inserts_past_capacity() {
+  const std::string name = sharedTestName("full");
+  SharedMap::unlink(name);
+
+  SharedMap map;
+  assert(map.create(name, 32));
+
+  std::uint64_t inserted = 0;
+  while (map.insert(inserted, inserted)) ++inserted;
+  assert(inserted >= 32);
+  assert(inserted * 8 <= map.capacity() * 7);
+
+  assert(map.erase(0));
+  assert(map.insert(0, 42));
+
+  std::uint64_t value = 0;
+  assert(map.find(0, value));
+  assert(value == 42);
+
+  assert(SharedMap::unlink(name));
+}
+
+void test_shared_table_reuses_tombstones_under_churn() {
+  const std::string name = sharedTestName("churn");
+  SharedMap::unlink(name);
+
+  SharedMap map;
+  assert(map.create(name, 1000));
+  assert(map.capacity() == 2048);
+
+  // A rolling window of 100 live keys pushes far more inserts than slots
+  // through the table; tombstones must be reused or purged.
+  for (std::uint64_t k = 0; k < 20000; ++k) {
+    assert(map.insert(k, k * 2));
+    if (k >= 100) assert(map.erase(k - 100));
+  }
+  assert(map.size() == 100);
+
+  std::uint64_t value = 0;
+  for (std::uint64_t k = 19900; k < 20000; ++k) {
+    assert(map.find(k, value));
+    assert(value == k * 2);
+  }
+  assert(!map.find(19899, value));
+
+  assert(map.purgeTombstones());
+  assert(map.size() == 100);
+  for (std::uint64_t k = 19900; k < 20000; ++k) {
+    assert(map.find(k, value));
+  }
+
+  assert(SharedMap::unlink(name));
+}
+
+void test_shared_table_reader_survives_purges() {
+  const std::string name = sharedTestName("purge");
+  SharedMap::unlink(name);
+
+  constexpr std::uint64_t kStable = 1024;
+  constexpr std::uint64_t kDone = ~std::uint64_t{0};
+
+  SharedMap writer;
+  assert(writer.create(name, 2048));
+  for (std::uint64_t i = 0; i < kStable; ++i) {
+    assert(writer.insert(i, i));
+  }
+
+  pid_t pid = ::fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    SharedMap reader;
+    if (!reader.open(name)) ::_exit(1);
+    std::uint64_t value = 0;
+    while (!reader.find(kDone, value)) {
+      for (std::uint64_t i = 0; i < kStable; ++i) {
+        if (!reader.find(i, value)) ::_exit(2);
+        if (value != i) ::_exit(3);
+      }
+    }
+    ::_exit(0);
+  }
+
+  for (std::uint64_t k = kStable; k < kStable + 200000; ++k) {
+    assert(writer.insert(k, k));
+    if (k >= kStable + 256) assert(writer.erase(k - 256));
+  }
+  assert(writer.insert(kDone, 0));
+
+  int status = 0;
+  assert(::waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  assert(SharedMap::unlink(name));
+}
+
+void test_shared_table_reader_gives_up_on_dead_writer() {
+  const std::string name = sharedTestName("stalled");
+  SharedMap::unlink(name);
+
+  SharedMap writer;
+  assert(writer.create(name, 256));
+  for (std::uint64_t i = 0; i < 256; ++i) {
+    assert(writer.insert(i, i));
+  }
+
+  // Map the segment a second time to fake a writer that died mid-update.
+  int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  assert(fd >= 0);
+  struct stat st{};
+  assert(::fstat(fd, &st) == 0);
+  void* raw = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  assert(raw != MAP_FAILED);
+  auto* header = static_cast<pxhash::SharedHeader*>(raw);
+  auto* versions =
+      reinterpret_cast<std::atomic<std::uint32_t>*>(static_cast<char*>(raw) + header->versions_offset);
+  const std::size_t blocks = header->capacity / pxhash::GROUP_SIZE;
+
+  SharedMap reader;
+  assert(reader.open(name));
+  reader.setStallTimeout(std::chrono::milliseconds(20));
+
+  std::uint64_t value = 0;
+  for (std::size_t b = 0; b < blocks; ++b) versions[b].fetch_add(1);
+  assert(reader.tryFind(5, value) == pxhash::SharedFindResult::Stalled);
+  assert(!reader.find(5, value));
+  for (std::size_t b = 0; b < blocks; ++b) versions[b].fetch_add(1);
+
+  header->epoch.fetch_add(1);
+  assert(reader.tryFind(5, value) == pxhash::SharedFindResult::Stalled);
+  header->epoch.fetch_add(1);
+
+  assert(reader.tryFind(5, value) == pxhash::SharedFindResult::Found);
+  assert(value == 5);
+  assert(reader.tryFind(1000, value) == pxhash::SharedFindResult::Missing);
+
+  ::munmap(raw, static_cast<size_t>(st.st_size));
+  assert(SharedMap::unlink(name));
+}
+
+void test_shared_table_concurrent_reader_process() {
+  const std::string name = sharedTestName("concurrent");
+  SharedMap::unlink(name);
+
+  SharedMap writer;
+  assert(writer.create(name, 4096));
+  for (std::uint64_t i = 0; i < 2048; ++i) {
+    assert(writer.insert(i, i));
+  }
+
+  pid_t pid = ::fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    SharedMap reader;
+    if (!reader.open(name)) ::_exit(1);
+    for (int round = 0; round < 200; ++round) {
+      for (std::uint64_t i = 0; i < 2048; ++i) {
+        std::uint64_t value = 0;
+        // Values are always i or i + 1'000'000 * k; anything else is a torn read.
+        if (!reader.find(i, value)) ::_exit(2);
+        if (value % 1'000'000 != i) ::_exit(3);
+      }
+    }
+    ::_exit(0);
+  }
+
+  for (std::uint64_t k = 1; k <= 50; ++k) {
+    for (std::uint64_t i = 0; i < 2048; ++i) {
+      assert(writer.insert(i, i + 1'000'000 * k));
+    }
+  }
+
+  int status = 0;
+  assert(::waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  assert(SharedMap::unlink(name));
+}
+#endif
+
 }  // namespace
 
 int main() {
@@ -164,8 +841,27 @@ int main() {
   test_erase_and_reuse_deleted_slots();
   test_growth_preserves_values();
   test_collision_heavy_workload();
+  test_probe_window_wrapping_keeps_tail_entries();
+  test_triangular_probing_policy();
+  test_triangular_probing_visits_every_group();
+  test_async_find_matches_sync_find();
+  test_async_find_dependent_lookups_over_collisions();
   test_move_insert_support();
   test_binary_roundtrip_for_trivial_types();
   test_binary_serialization_rejects_non_trivial_types();
+  test_incremental_checkpoint_chain();
+  test_delta_log_ignores_torn_tail();
+  test_durable_table_recovers_checkpoints_and_log();
+  test_durable_checkpoint_retries_after_failed_publish();
+  test_durable_replay_of_updates_keeps_capacity();
+  test_durable_full_checkpoint_removes_live_chain();
+#if PXHASH_HAS_SHM
+  test_shared_table_writer_and_reader_views();
+  test_shared_table_rejects_inserts_past_capacity();
+  test_shared_table_reuses_tombstones_under_churn();
+  test_shared_table_reader_survives_purges();
+  test_shared_table_reader_gives_up_on_dead_writer();
+  test_shared_table_concurrent_reader_process();
+#endif
   return 0;
 }